@@ -1,4 +1,46 @@
-add_executable(embed embed/source.cpp)
+find_package(Threads REQUIRED)
+
+add_executable(embed embed/source.cpp core/image.cpp core/image_kernels.cpp core/block_compression.cpp core/atlas_packing.cpp)
+target_include_directories(embed PRIVATE ${CMAKE_CURRENT_SOURCE_DIR})
+target_link_libraries(embed PRIVATE Threads::Threads)
+
+# How embed hands the bytes to the compiler: C23 #embed where the compiler
+# takes it in C++, an assembler .incbin where there is a GNU style assembler,
+# and a string literal anywhere else. Assets never go through the C++ parser
+# as numbers, and the pixels stay in read-only data.
+set(EMBED_OUTPUT auto CACHE STRING "How embedded data is compiled: auto, embed, incbin or string")
+if (EMBED_OUTPUT STREQUAL "auto")
+    include(CheckCXXSourceCompiles)
+    set(EMBED_CHECK_DIR ${CMAKE_CURRENT_BINARY_DIR}/embed_check)
+    file(WRITE ${EMBED_CHECK_DIR}/data.bin "x")
+    file(WRITE ${EMBED_CHECK_DIR}/data.h "#pragma GCC system_header\n#embed \"data.bin\"\n")
+    check_cxx_source_compiles("
+        static unsigned char const data[] = {
+        #include \"${EMBED_CHECK_DIR}/data.h\"
+        };
+        int main() { return data[0] == 'x' ? 0 : 1; }
+    " HAS_CXX_EMBED)
+    if (HAS_CXX_EMBED)
+        set(EMBED_MODE embed)
+    elseif (CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang" AND NOT WIN32)
+        set(EMBED_MODE incbin)
+    else()
+        set(EMBED_MODE string)
+    endif()
+else()
+    set(EMBED_MODE ${EMBED_OUTPUT})
+endif()
+if (EMBED_MODE STREQUAL "incbin")
+    enable_language(ASM)
+endif()
+message(STATUS "Embedding resources through: ${EMBED_MODE}")
+
+# Block format of every baked texture: BC1 for opaque colors, BC3 and BC7 for
+# colors with alpha, BC4 for single channel data.
+set(COMPRESS_wood_container bc1)
+set(COMPRESS_awesomeface bc3)
+set(COMPRESS_container2 bc7)
+set(COMPRESS_container2_specular bc4)
 
 set(RESOURCES_DIR ${CMAKE_CURRENT_SOURCE_DIR}/../resources)
 file(GLOB_RECURSE IMG_RESOURCES ${RESOURCES_DIR}/img/*)
@@ -7,18 +49,78 @@ set(IMG_RESOURCES_OUTPUT_DIR ${GENERATED_FILES}/resources/img)
 make_directory(${IMG_RESOURCES_OUTPUT_DIR})
 
 set(RESULT_IMG_RESOURCES)
+# Assembler sources of the .incbin objects, they are linked into the executable.
+set(EMBED_SOURCES)
 
 foreach(IMG_RESOURCE ${IMG_RESOURCES})
     get_filename_component(RES_NAME ${IMG_RESOURCE} NAME_WLE)
 
+    set(RAW_OUTPUTS ${IMG_RESOURCES_OUTPUT_DIR}/${RES_NAME}.h)
+    set(BAKED_OUTPUTS ${IMG_RESOURCES_OUTPUT_DIR}/${RES_NAME}.baked.h)
+    if (NOT EMBED_MODE STREQUAL "string")
+        list(APPEND BAKED_OUTPUTS ${IMG_RESOURCES_OUTPUT_DIR}/${RES_NAME}.baked.bin)
+    endif()
+    if (EMBED_MODE STREQUAL "incbin")
+        list(APPEND RAW_OUTPUTS ${IMG_RESOURCES_OUTPUT_DIR}/${RES_NAME}.S)
+        list(APPEND BAKED_OUTPUTS ${IMG_RESOURCES_OUTPUT_DIR}/${RES_NAME}.baked.S)
+        list(APPEND EMBED_SOURCES ${IMG_RESOURCES_OUTPUT_DIR}/${RES_NAME}.S ${IMG_RESOURCES_OUTPUT_DIR}/${RES_NAME}.baked.S)
+    endif()
+
+    add_custom_command(
+        OUTPUT ${RAW_OUTPUTS}
+        COMMAND embed --output ${EMBED_MODE} ${IMG_RESOURCE} ${IMG_RESOURCES_OUTPUT_DIR}
+        DEPENDS embed ${IMG_RESOURCE}
+    )
+
+    # Baked mips can afford the sharper filter. Specular maps hold data rather
+    # than colors, so their mips are not gamma-corrected.
+    set(BAKE_FLAGS --filter kaiser)
+    if (RES_NAME MATCHES "_specular$")
+        list(APPEND BAKE_FLAGS --linear)
+    endif()
+    if (DEFINED COMPRESS_${RES_NAME})
+        list(APPEND BAKE_FLAGS --compress ${COMPRESS_${RES_NAME}})
+    endif()
+
     add_custom_command(
-        OUTPUT ${RES_NAME}.h
-        COMMAND embed ${IMG_RESOURCE} ${IMG_RESOURCES_OUTPUT_DIR}
-        DEPENDS embed
+        OUTPUT ${BAKED_OUTPUTS}
+        COMMAND embed --output ${EMBED_MODE} --bake ${BAKE_FLAGS} ${IMG_RESOURCE} ${IMG_RESOURCES_OUTPUT_DIR}
+        DEPENDS embed ${IMG_RESOURCE}
     )
 
-    set(RESULT_IMG_RESOURCES ${RESULT_IMG_RESOURCES} ${RES_NAME}.h)
+    set(RESULT_IMG_RESOURCES ${RESULT_IMG_RESOURCES} ${RAW_OUTPUTS} ${BAKED_OUTPUTS})
+
+endforeach()
+
+# Atlases packed at build time, each a single compressed page. Every level is
+# made of the images' own mips, a gutter of 32 texels keeps six of them, until
+# 512x512 images are 16x16 with a texel of gutter left.
+set(ATLASES wood_and_face)
+set(ATLAS_wood_and_face wood_container.jpg awesomeface.png)
+set(COMPRESS_wood_and_face bc7)
+
+foreach(ATLAS ${ATLASES})
+    set(ATLAS_IMAGES)
+    foreach(IMAGE ${ATLAS_${ATLAS}})
+        list(APPEND ATLAS_IMAGES ${RESOURCES_DIR}/img/${IMAGE})
+    endforeach()
+
+    set(ATLAS_OUTPUTS ${IMG_RESOURCES_OUTPUT_DIR}/${ATLAS}.baked.h)
+    if (NOT EMBED_MODE STREQUAL "string")
+        list(APPEND ATLAS_OUTPUTS ${IMG_RESOURCES_OUTPUT_DIR}/${ATLAS}.baked.bin)
+    endif()
+    if (EMBED_MODE STREQUAL "incbin")
+        list(APPEND ATLAS_OUTPUTS ${IMG_RESOURCES_OUTPUT_DIR}/${ATLAS}.baked.S)
+        list(APPEND EMBED_SOURCES ${IMG_RESOURCES_OUTPUT_DIR}/${ATLAS}.baked.S)
+    endif()
+
+    add_custom_command(
+        OUTPUT ${ATLAS_OUTPUTS}
+        COMMAND embed --output ${EMBED_MODE} --atlas ${ATLAS} --padding 32 --filter kaiser --compress ${COMPRESS_${ATLAS}} ${ATLAS_IMAGES} ${IMG_RESOURCES_OUTPUT_DIR}
+        DEPENDS embed ${ATLAS_IMAGES}
+    )
 
+    set(RESULT_IMG_RESOURCES ${RESULT_IMG_RESOURCES} ${ATLAS_OUTPUTS})
 endforeach()
 
 add_custom_target(
@@ -0,0 +1,255 @@
+#include "atlas_packing.h"
+#include "exception.h"
+#include "image_kernels.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <numeric>
+
+namespace core {
+
+namespace {
+
+// Page widths tried when looking for the smallest single page.
+constexpr size_t WIDTH_CANDIDATES = 64;
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+struct Placement {
+    size_t image;
+    size_t x;
+    size_t y;
+};
+
+// Places images in `order` until one does not fit.
+std::vector<Placement> place(SkylinePacker & packer, std::span<size_t const> order, std::span<Image const * const> images, size_t padding) {
+    std::vector<Placement> placements;
+    for (size_t i : order) {
+        auto position = packer.insert(roundUp(images[i]->width + 2 * padding, padding), roundUp(images[i]->height + 2 * padding, padding));
+        if (!position)
+            break;
+        placements.push_back({ i, position->x, position->y });
+    }
+    return placements;
+}
+
+// Copies the image into the page with its edge pixels repeated `padding` times around it.
+void blit(Image & page, Image const & source, size_t x, size_t y, size_t padding) {
+    // Pages are RGBA8, other formats are converted first.
+    std::optional<Image> expanded;
+    if (source.format != Image::Format::RGB && source.format != Image::Format::RGBA)
+        expanded = converted(source, Image::Format::RGBA);
+    auto const & image = expanded ? *expanded : source;
+    size_t channels = channelsOf(image.format);
+    size_t row_bytes = image.width * channels;
+    for (size_t row = 0; row < image.height + 2 * padding; ++row) {
+        size_t src_y = std::min(row - std::min(row, padding), image.height - 1);
+        std::span<std::byte const> src(image.image.data() + src_y * row_bytes, row_bytes);
+        auto * dst = page.image.data() + ((y + row) * page.width + x) * 4;
+        std::span<std::byte> inside(dst + padding * 4, image.width * 4);
+        if (channels == 3) {
+            kernels::expandRgbToRgba(src, inside);
+        } else {
+            std::copy(src.begin(), src.end(), inside.begin());
+        }
+        for (size_t column = 0; column < padding; ++column) {
+            std::copy_n(inside.data(), 4, dst + column * 4);
+            std::copy_n(inside.data() + inside.size() - 4, 4, inside.data() + inside.size() + column * 4);
+        }
+    }
+}
+
+Image emptyPage(size_t width, size_t height) {
+    return {
+        .width = width,
+        .height = height,
+        .format = Image::Format::RGBA,
+        .image = PixelStorage(width * height * 4),
+    };
+}
+
+} // namespace
+
+SkylinePacker::SkylinePacker(size_t width, size_t height)
+    : width(width)
+    , height(height)
+    , skyline{{ .x = 0, .y = 0, .width = width }}
+{}
+
+std::optional<size_t> SkylinePacker::fit(size_t i, size_t rect_width, size_t rect_height) const {
+    if (skyline[i].x + rect_width > width)
+        return std::nullopt;
+    // The rectangle rests on the highest segment below it.
+    size_t y = 0;
+    size_t remaining = rect_width;
+    for (size_t j = i; remaining > 0; ++j) {
+        y = std::max(y, skyline[j].y);
+        remaining -= std::min(remaining, skyline[j].width);
+    }
+    if (y + rect_height > height)
+        return std::nullopt;
+    return y;
+}
+
+std::optional<SkylinePacker::Position> SkylinePacker::insert(size_t rect_width, size_t rect_height) {
+    REQUIRE(rect_width > 0 && rect_height > 0, "Packed rectangles should not be empty");
+    size_t best = skyline.size();
+    size_t best_y = 0;
+    size_t best_top = SIZE_MAX;
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        auto y = fit(i, rect_width, rect_height);
+        if (!y)
+            continue;
+        // Lowest top edge first, then the snuggest segment.
+        size_t top = *y + rect_height;
+        if (top < best_top || (top == best_top && skyline[i].width < skyline[best].width)) {
+            best = i;
+            best_y = *y;
+            best_top = top;
+        }
+    }
+    if (best == skyline.size())
+        return std::nullopt;
+
+    Segment placed { .x = skyline[best].x, .y = best_top, .width = rect_width };
+    skyline.insert(skyline.begin() + std::ptrdiff_t(best), placed);
+
+    // Segments under the new one are cut back to where it ends.
+    size_t end = placed.x + placed.width;
+    for (size_t j = best + 1; j < skyline.size() && skyline[j].x < end;) {
+        auto & segment = skyline[j];
+        size_t covered = std::min(segment.width, end - segment.x);
+        segment.x += covered;
+        segment.width -= covered;
+        if (segment.width > 0)
+            break;
+        skyline.erase(skyline.begin() + std::ptrdiff_t(j));
+    }
+
+    for (size_t j = 0; j + 1 < skyline.size();) {
+        if (skyline[j].y == skyline[j + 1].y) {
+            skyline[j].width += skyline[j + 1].width;
+            skyline.erase(skyline.begin() + std::ptrdiff_t(j + 1));
+        } else {
+            ++j;
+        }
+    }
+    return Position { placed.x, best_y };
+}
+
+size_t SkylinePacker::usedHeight() const noexcept {
+    size_t used = 0;
+    for (auto const & segment : skyline)
+        used = std::max(used, segment.y);
+    return used;
+}
+
+AtlasLayout layoutAtlas(std::span<Image const * const> images, size_t padding, size_t max_size) {
+    REQUIRE(!images.empty(), "Atlas should have at least one image");
+    REQUIRE(std::has_single_bit(padding), "Atlas padding should be a power of two");
+    REQUIRE(max_size % padding == 0, "Atlas size should be a multiple of its padding");
+
+    size_t min_width = 0;
+    size_t area = 0;
+    for (auto const * image : images) {
+        REQUIRE(!isCompressed(image->format), "Atlas images should not be compressed");
+        size_t width = roundUp(image->width + 2 * padding, padding);
+        size_t height = roundUp(image->height + 2 * padding, padding);
+        REQUIRE(width <= max_size && height <= max_size, "Image does not fit into an atlas page");
+        min_width = std::max(min_width, width);
+        area += width * height;
+    }
+
+    // Tallest first, the skyline stays flatter that way.
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return images[a]->height != images[b]->height ? images[a]->height > images[b]->height : images[a]->width > images[b]->width;
+    });
+
+    // The smallest single page is looked for among widths from the widest image up.
+    std::vector<Placement> placements;
+    size_t page_width = max_size;
+    size_t page_height = max_size;
+    size_t best_area = SIZE_MAX;
+    size_t step = std::max(padding, roundUp((max_size - min_width) / WIDTH_CANDIDATES, padding));
+    for (size_t width = min_width; width <= max_size; width += step) {
+        if (width * max_size < area)
+            continue;
+        SkylinePacker packer(width, max_size);
+        auto candidate = place(packer, order, images, padding);
+        size_t height = packer.usedHeight();
+        if (candidate.size() == images.size() && width * height < best_area) {
+            best_area = width * height;
+            placements = std::move(candidate);
+            page_width = width;
+            page_height = height;
+        }
+    }
+
+    AtlasLayout layout {
+        .page_width = page_width,
+        .page_height = page_height,
+        .pages = 0,
+        .padding = padding,
+        .placements = std::vector<AtlasLayout::Placement>(images.size()),
+        .regions = std::vector<AtlasRegion>(images.size()),
+    };
+    auto add = [&](std::span<Placement const> page_placements) {
+        for (auto const & placement : page_placements) {
+            auto const & image = *images[placement.image];
+            layout.placements[placement.image] = { .page = layout.pages, .x = placement.x, .y = placement.y };
+            layout.regions[placement.image] = atlasRegion(placement.x + padding, placement.y + padding,
+                image.width, image.height, page_width, page_height, layout.pages);
+        }
+        ++layout.pages;
+    };
+
+    if (!placements.empty()) {
+        add(placements);
+        return layout;
+    }
+
+    // Too much for one page: full pages, so that they can be layers of one array.
+    std::span<size_t const> remaining = order;
+    while (!remaining.empty()) {
+        SkylinePacker packer(max_size, max_size);
+        auto page_placements = place(packer, remaining, images, padding);
+        add(page_placements);
+        remaining = remaining.subspan(page_placements.size());
+    }
+    return layout;
+}
+
+std::vector<Image> renderAtlas(AtlasLayout const & layout, std::span<Image const * const> images, size_t level) {
+    REQUIRE(images.size() == layout.placements.size(), "Atlas is rendered from other images than it was laid out for");
+    REQUIRE(level <= size_t(std::countr_zero(layout.padding)), "Atlas levels past log2(padding) have no gutter left");
+    size_t padding = std::max<size_t>(layout.padding >> level, 1);
+
+    std::vector<Image> pages;
+    for (size_t page = 0; page < layout.pages; ++page)
+        pages.push_back(emptyPage(std::max<size_t>(layout.page_width >> level, 1), std::max<size_t>(layout.page_height >> level, 1)));
+    for (size_t i = 0; i < images.size(); ++i) {
+        auto const & placement = layout.placements[i];
+        blit(pages[placement.page], *images[i], placement.x >> level, placement.y >> level, padding);
+    }
+    return pages;
+}
+
+AtlasRegion atlasRegion(size_t x, size_t y, size_t width, size_t height, size_t page_width, size_t page_height, size_t layer) {
+    return {
+        .offset = { float(x) / float(page_width), float(y) / float(page_height) },
+        .scale = { float(width) / float(page_width), float(height) / float(page_height) },
+        .layer = layer,
+    };
+}
+
+PackedAtlas packAtlas(std::span<Image const * const> images, size_t padding, size_t max_size) {
+    auto layout = layoutAtlas(images, padding, max_size);
+    return { .pages = renderAtlas(layout, images), .regions = std::move(layout.regions) };
+}
+
+} // namespace core
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "image.h"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace core {
+
+// Bottom-left skyline packing: the top edge of everything placed so far is
+// kept as horizontal segments, a rectangle goes where it ends up lowest.
+class SkylinePacker {
+public:
+    struct Position {
+        size_t x;
+        size_t y;
+    };
+
+    SkylinePacker(size_t width, size_t height);
+
+    std::optional<Position> insert(size_t width, size_t height);
+
+    // Lowest height which holds everything inserted so far.
+    size_t usedHeight() const noexcept;
+
+private:
+    struct Segment {
+        size_t x;
+        size_t y;
+        size_t width;
+    };
+
+    // Top of a `width` x `height` rectangle whose left edge is on segment `i`, if it fits.
+    std::optional<size_t> fit(size_t i, size_t width, size_t height) const;
+
+    size_t width;
+    size_t height;
+    std::vector<Segment> skyline;
+};
+
+// Where a sub-image lives in its atlas: uv' = offset + uv * scale on `layer`.
+struct AtlasRegion {
+    glm::vec2 offset;
+    glm::vec2 scale;
+    size_t layer;
+
+    // Offset in xy and scale in zw, the way shaders take it.
+    glm::vec4 transform() const { return glm::vec4(offset, scale); }
+};
+
+struct PackedAtlas {
+    // RGBA, all of the same size.
+    std::vector<Image> pages;
+    // In the order of the packed images.
+    std::vector<AtlasRegion> regions;
+};
+
+// Packs the images into as few pages of at most `max_size` x `max_size` as
+// possible, each one as small as possible. Every image keeps a gutter of
+// `padding` replicated edge pixels and starts at a multiple of `padding`, so
+// its first log2(padding) + 1 mips do not bleed into the neighbours.
+PackedAtlas packAtlas(std::span<Image const * const> images, size_t padding, size_t max_size);
+
+// Where `packAtlas` puts the images, without any pixels.
+struct AtlasLayout {
+    struct Placement {
+        size_t page;
+        // The top-left corner of the gutter.
+        size_t x;
+        size_t y;
+    };
+
+    size_t page_width;
+    size_t page_height;
+    size_t pages;
+    size_t padding;
+    // In the order of the packed images.
+    std::vector<Placement> placements;
+    std::vector<AtlasRegion> regions;
+};
+
+AtlasLayout layoutAtlas(std::span<Image const * const> images, size_t padding, size_t max_size);
+
+// The pages at mip `level`, made of `images`, which are the packed images at
+// that level. Positions and gutters are halved `level` times, so up to level
+// log2(padding) regions start on whole texels and keep a texel of gutter, and
+// no level blends neighbouring images the way mipmapping a whole page does.
+std::vector<Image> renderAtlas(AtlasLayout const & layout, std::span<Image const * const> images, size_t level = 0);
+
+// uv' = offset + uv * scale of a `width` x `height` image with its top-left texel at `x`, `y`.
+AtlasRegion atlasRegion(size_t x, size_t y, size_t width, size_t height, size_t page_width, size_t page_height, size_t layer);
+
+// A single page atlas packed and mipmapped at build time, see `embed --atlas`.
+struct BakedAtlas {
+    BakedImage page;
+    std::vector<AtlasRegion> regions;
+};
+
+} // namespace core
@@ -1,11 +1,20 @@
 #pragma once
+#include <compare>
 #include <cstdint>
+#include <vector>
 
 namespace core {
 
 struct Attribute {
     enum class Type {
-        Float
+        Float,
+        HalfFloat,
+        Byte,
+        UnsignedByte,
+        Short,
+        UnsignedShort,
+        // Four signed components packed into 32 bits, `size` has to be 4.
+        Int2_10_10_10_Rev,
     };
 
     char const * name;
@@ -28,6 +37,16 @@ struct LocatedAttribute {
     Attribute::Type type;
     uintptr_t offset;
     bool normalize;
+
+    auto operator<=>(LocatedAttribute const &) const = default;
+};
+
+// Everything a VAO has to know about the vertices apart from the buffer they live in.
+struct VertexLayout {
+    std::vector<LocatedAttribute> attributes;
+    unsigned int stride = 0;
+
+    auto operator<=>(VertexLayout const &) const = default;
 };
 
 } // namespace core
@@ -0,0 +1,568 @@
+#include "block_compression.h"
+#include "exception.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace core {
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 4;
+constexpr size_t TEXELS = BLOCK_SIZE * BLOCK_SIZE;
+
+using Color = std::array<float, 4>;
+using Indices = std::array<uint8_t, TEXELS>;
+
+// Texels of a block stored channel by channel, so that four of them fill an SSE register.
+struct Block {
+    alignas(16) float channels[4][TEXELS];
+};
+
+Block loadBlock(Image const & image, size_t block_x, size_t block_y) {
+    Block block;
+    size_t channels = channelsOf(image.format);
+    for (size_t i = 0; i < TEXELS; ++i) {
+        // Blocks over the right and bottom edges repeat the last column and row.
+        size_t x = std::min(block_x * BLOCK_SIZE + i % BLOCK_SIZE, image.width - 1);
+        size_t y = std::min(block_y * BLOCK_SIZE + i / BLOCK_SIZE, image.height - 1);
+        auto const * texel = image.image.data() + (y * image.width + x) * channels;
+        for (size_t c = 0; c < 4; ++c)
+            block.channels[c][i] = c < channels ? float(std::to_integer<unsigned char>(texel[c])) : 255.0f;
+    }
+    return block;
+}
+
+// Picks the closest palette entry for every texel, comparing channels [first, first + count).
+// Returns the summed squared error of the block.
+float selectIndices(Block const & block, size_t first, size_t count, std::span<Color const> palette, Indices & indices) {
+#if defined(__SSE2__)
+    __m128 total = _mm_setzero_ps();
+    for (size_t group = 0; group < TEXELS; group += 4) {
+        __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128 best_index = _mm_setzero_ps();
+        for (size_t p = 0; p < palette.size(); ++p) {
+            __m128 error = _mm_setzero_ps();
+            for (size_t c = first; c < first + count; ++c) {
+                __m128 difference = _mm_sub_ps(_mm_load_ps(&block.channels[c][group]), _mm_set1_ps(palette[p][c]));
+                error = _mm_add_ps(error, _mm_mul_ps(difference, difference));
+            }
+            __m128 closer = _mm_cmplt_ps(error, best);
+            best = _mm_min_ps(error, best);
+            best_index = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps(float(p))), _mm_andnot_ps(closer, best_index));
+        }
+        total = _mm_add_ps(total, best);
+
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, best_index);
+        for (size_t lane = 0; lane < 4; ++lane)
+            indices[group + lane] = uint8_t(lanes[lane]);
+    }
+    alignas(16) float sums[4];
+    _mm_store_ps(sums, total);
+    return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+    float total = 0;
+    for (size_t i = 0; i < TEXELS; ++i) {
+        float best = std::numeric_limits<float>::max();
+        for (size_t p = 0; p < palette.size(); ++p) {
+            float error = 0;
+            for (size_t c = first; c < first + count; ++c) {
+                float difference = block.channels[c][i] - palette[p][c];
+                error += difference * difference;
+            }
+            if (error < best) {
+                best = error;
+                indices[i] = uint8_t(p);
+            }
+        }
+        total += best;
+    }
+    return total;
+#endif
+}
+
+// Ends of the segment covering the texels along their principal axis.
+std::pair<Color, Color> principalEndpoints(Block const & block, size_t first, size_t count) {
+    Color mean {};
+    Color axis {};
+    for (size_t c = first; c < first + count; ++c) {
+        auto [lo, hi] = std::minmax_element(std::begin(block.channels[c]), std::end(block.channels[c]));
+        for (auto value : block.channels[c])
+            mean[c] += value / float(TEXELS);
+        axis[c] = *hi - *lo;
+    }
+
+    float covariance[4][4] = {};
+    for (size_t i = 0; i < TEXELS; ++i) {
+        for (size_t a = first; a < first + count; ++a) {
+            for (size_t b = first; b < first + count; ++b)
+                covariance[a][b] += (block.channels[a][i] - mean[a]) * (block.channels[b][i] - mean[b]);
+        }
+    }
+
+    // Power iteration, starting from the diagonal of the bounding box.
+    for (size_t iteration = 0; iteration < 8; ++iteration) {
+        Color next {};
+        float largest = 0;
+        for (size_t a = first; a < first + count; ++a) {
+            for (size_t b = first; b < first + count; ++b)
+                next[a] += covariance[a][b] * axis[b];
+            largest = std::max(largest, std::abs(next[a]));
+        }
+        if (largest <= 0)
+            break;
+        for (size_t c = first; c < first + count; ++c)
+            axis[c] = next[c] / largest;
+    }
+
+    float length = 0;
+    for (size_t c = first; c < first + count; ++c)
+        length += axis[c] * axis[c];
+    length = std::sqrt(length);
+    if (length > 0) {
+        for (size_t c = first; c < first + count; ++c)
+            axis[c] /= length;
+    }
+
+    float lo = 0;
+    float hi = 0;
+    for (size_t i = 0; i < TEXELS; ++i) {
+        float t = 0;
+        for (size_t c = first; c < first + count; ++c)
+            t += (block.channels[c][i] - mean[c]) * axis[c];
+        lo = std::min(lo, t);
+        hi = std::max(hi, t);
+    }
+
+    Color start {};
+    Color end {};
+    for (size_t c = first; c < first + count; ++c) {
+        start[c] = std::clamp(mean[c] + lo * axis[c], 0.0f, 255.0f);
+        end[c] = std::clamp(mean[c] + hi * axis[c], 0.0f, 255.0f);
+    }
+    return { start, end };
+}
+
+// Least squares endpoints for fixed indices, texel i being `(1 - w) * start + w * end`
+// with `w = weights[indices[i]]`. Fails when all texels use the same weight.
+bool refit(Block const & block, size_t first, size_t count, Indices const & indices, std::span<float const> weights, Color & start, Color & end) {
+    float aa = 0, ab = 0, bb = 0;
+    Color ax {};
+    Color bx {};
+    for (size_t i = 0; i < TEXELS; ++i) {
+        float w = weights[indices[i]];
+        float a = 1 - w;
+        aa += a * a;
+        ab += a * w;
+        bb += w * w;
+        for (size_t c = first; c < first + count; ++c) {
+            ax[c] += a * block.channels[c][i];
+            bx[c] += w * block.channels[c][i];
+        }
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f)
+        return false;
+    for (size_t c = first; c < first + count; ++c) {
+        start[c] = std::clamp((bb * ax[c] - ab * bx[c]) / determinant, 0.0f, 255.0f);
+        end[c] = std::clamp((aa * bx[c] - ab * ax[c]) / determinant, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+void store(std::byte * out, uint64_t bits, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i)
+        out[i] = std::byte(bits >> (8 * i) & 0xff);
+}
+
+uint64_t load(std::byte const * in, size_t bytes) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < bytes; ++i)
+        bits |= uint64_t(std::to_integer<uint8_t>(in[i])) << (8 * i);
+    return bits;
+}
+
+// BC1 colors
+
+constexpr float COLOR_WEIGHTS[] = { 0.0f, 1.0f, 1.0f / 3, 2.0f / 3 };
+
+uint16_t to565(Color const & color) {
+    auto quantize = [](float value, float max) {
+        return unsigned(std::lround(value * max / 255.0f));
+    };
+    return uint16_t(quantize(color[0], 31) << 11 | quantize(color[1], 63) << 5 | quantize(color[2], 31));
+}
+
+std::array<unsigned, 3> from565(unsigned value) {
+    unsigned r = value >> 11 & 31;
+    unsigned g = value >> 5 & 63;
+    unsigned b = value & 31;
+    return { r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2 };
+}
+
+struct ColorFit {
+    uint16_t endpoints[2];
+    Indices indices;
+    float error;
+};
+
+ColorFit fitColors(Block const & block, Color const & start, Color const & end) {
+    ColorFit fit { { to565(start), to565(end) }, {}, 0 };
+    // Only the four color mode is written, which the decoder picks when c0 > c1.
+    if (fit.endpoints[0] < fit.endpoints[1])
+        std::swap(fit.endpoints[0], fit.endpoints[1]);
+
+    auto c0 = from565(fit.endpoints[0]);
+    auto c1 = from565(fit.endpoints[1]);
+    std::array<Color, 4> palette {};
+    for (size_t i = 0; i < palette.size(); ++i) {
+        for (size_t c = 0; c < 3; ++c)
+            palette[i][c] = float(c0[c]) * (1 - COLOR_WEIGHTS[i]) + float(c1[c]) * COLOR_WEIGHTS[i];
+    }
+    fit.error = selectIndices(block, 0, 3, palette, fit.indices);
+    return fit;
+}
+
+void encodeColors(Block const & block, std::byte * out) {
+    auto [start, end] = principalEndpoints(block, 0, 3);
+    auto best = fitColors(block, start, end);
+    if (refit(block, 0, 3, best.indices, COLOR_WEIGHTS, start, end)) {
+        auto refined = fitColors(block, start, end);
+        if (refined.error < best.error)
+            best = refined;
+    }
+
+    uint64_t bits = uint64_t(best.endpoints[0]) | uint64_t(best.endpoints[1]) << 16;
+    for (size_t i = 0; i < TEXELS; ++i)
+        bits |= uint64_t(best.indices[i]) << (32 + 2 * i);
+    store(out, bits, 8);
+}
+
+void decodeColors(std::byte const * in, bool four_colors, std::array<std::array<uint8_t, 4>, TEXELS> & texels) {
+    uint64_t bits = load(in, 8);
+    unsigned e0 = bits & 0xffff;
+    unsigned e1 = bits >> 16 & 0xffff;
+    auto c0 = from565(e0);
+    auto c1 = from565(e1);
+
+    std::array<std::array<unsigned, 4>, 4> palette;
+    for (size_t c = 0; c < 3; ++c) {
+        palette[0][c] = c0[c];
+        palette[1][c] = c1[c];
+        if (four_colors || e0 > e1) {
+            palette[2][c] = (2 * c0[c] + c1[c]) / 3;
+            palette[3][c] = (c0[c] + 2 * c1[c]) / 3;
+        } else {
+            palette[2][c] = (c0[c] + c1[c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    for (size_t i = 0; i < 4; ++i)
+        palette[i][3] = four_colors || e0 > e1 || i != 3 ? 255 : 0;
+
+    for (size_t i = 0; i < TEXELS; ++i) {
+        auto const & color = palette[bits >> (32 + 2 * i) & 3];
+        for (size_t c = 0; c < 4; ++c)
+            texels[i][c] = uint8_t(color[c]);
+    }
+}
+
+// BC4 single channel
+
+void encodeChannel(Block const & block, size_t channel, std::byte * out) {
+    auto [lo, hi] = std::minmax_element(std::begin(block.channels[channel]), std::end(block.channels[channel]));
+    // a0 > a1 selects eight interpolated values, equal ends make every index 0 decode to a0.
+    auto a0 = unsigned(std::lround(*hi));
+    auto a1 = unsigned(std::lround(*lo));
+
+    std::array<Color, 8> palette {};
+    palette[0][channel] = float(a0);
+    palette[1][channel] = float(a1);
+    for (unsigned i = 1; i < 7; ++i)
+        palette[i + 1][channel] = float((7 - i) * a0 + i * a1) / 7;
+
+    Indices indices;
+    selectIndices(block, channel, 1, palette, indices);
+
+    uint64_t bits = uint64_t(a0) | uint64_t(a1) << 8;
+    for (size_t i = 0; i < TEXELS; ++i)
+        bits |= uint64_t(indices[i]) << (16 + 3 * i);
+    store(out, bits, 8);
+}
+
+void decodeChannel(std::byte const * in, size_t channel, std::array<std::array<uint8_t, 4>, TEXELS> & texels) {
+    uint64_t bits = load(in, 8);
+    unsigned a0 = bits & 0xff;
+    unsigned a1 = bits >> 8 & 0xff;
+
+    std::array<unsigned, 8> palette { a0, a1 };
+    if (a0 > a1) {
+        for (unsigned i = 1; i < 7; ++i)
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+    } else {
+        for (unsigned i = 1; i < 5; ++i)
+            palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    for (size_t i = 0; i < TEXELS; ++i)
+        texels[i][channel] = uint8_t(palette[bits >> (16 + 3 * i) & 7]);
+}
+
+// BC7 mode 6
+
+constexpr unsigned BC7_WEIGHTS[] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+constexpr auto BC7_FACTORS = [] {
+    std::array<float, 16> factors {};
+    for (size_t i = 0; i < factors.size(); ++i)
+        factors[i] = float(BC7_WEIGHTS[i]) / 64;
+    return factors;
+}();
+
+unsigned interpolate(unsigned e0, unsigned e1, size_t index) {
+    return ((64 - BC7_WEIGHTS[index]) * e0 + BC7_WEIGHTS[index] * e1 + 32) >> 6;
+}
+
+// Seven bits per channel plus a shared lowest bit.
+struct Endpoint {
+    std::array<unsigned, 4> color;
+    unsigned p;
+
+    unsigned operator[](size_t c) const { return color[c] << 1 | p; }
+};
+
+Endpoint quantize(Color const & color) {
+    Endpoint best {};
+    float best_error = std::numeric_limits<float>::max();
+    for (unsigned p = 0; p < 2; ++p) {
+        Endpoint endpoint { {}, p };
+        float error = 0;
+        for (size_t c = 0; c < 4; ++c) {
+            endpoint.color[c] = unsigned(std::clamp(std::lround((color[c] - float(p)) / 2), 0l, 127l));
+            float difference = float(endpoint[c]) - color[c];
+            error += difference * difference;
+        }
+        if (error < best_error) {
+            best = endpoint;
+            best_error = error;
+        }
+    }
+    return best;
+}
+
+struct Bc7Fit {
+    Endpoint endpoints[2];
+    Indices indices;
+    float error;
+};
+
+Bc7Fit fitBc7(Block const & block, Color const & start, Color const & end) {
+    Bc7Fit fit { { quantize(start), quantize(end) }, {}, 0 };
+    std::array<Color, 16> palette;
+    for (size_t i = 0; i < palette.size(); ++i) {
+        for (size_t c = 0; c < 4; ++c)
+            palette[i][c] = float(interpolate(fit.endpoints[0][c], fit.endpoints[1][c], i));
+    }
+    fit.error = selectIndices(block, 0, 4, palette, fit.indices);
+    return fit;
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::byte * out) : out(out) {}
+
+    void put(unsigned value, size_t bits) {
+        for (size_t i = 0; i < bits; ++i, ++position) {
+            if (value >> i & 1)
+                out[position / 8] |= std::byte(1 << position % 8);
+        }
+    }
+
+private:
+    std::byte * out;
+    size_t position = 0;
+};
+
+class BitReader {
+public:
+    explicit BitReader(std::byte const * in) : in(in) {}
+
+    unsigned get(size_t bits) {
+        unsigned value = 0;
+        for (size_t i = 0; i < bits; ++i, ++position)
+            value |= unsigned(std::to_integer<uint8_t>(in[position / 8]) >> position % 8 & 1) << i;
+        return value;
+    }
+
+private:
+    std::byte const * in;
+    size_t position = 0;
+};
+
+void encodeBc7(Block const & block, std::byte * out) {
+    auto [start, end] = principalEndpoints(block, 0, 4);
+    auto best = fitBc7(block, start, end);
+    for (size_t iteration = 0; iteration < 2; ++iteration) {
+        if (!refit(block, 0, 4, best.indices, BC7_FACTORS, start, end))
+            break;
+        auto refined = fitBc7(block, start, end);
+        if (refined.error >= best.error)
+            break;
+        best = refined;
+    }
+
+    // The top bit of the first index is implied to be 0, mirroring the palette keeps it so.
+    if (best.indices[0] >= 8) {
+        std::swap(best.endpoints[0], best.endpoints[1]);
+        for (auto & index : best.indices)
+            index = uint8_t(15 - index);
+    }
+
+    std::fill(out, out + 16, std::byte(0));
+    BitWriter writer(out);
+    writer.put(1 << 6, 7);
+    for (size_t c = 0; c < 4; ++c) {
+        writer.put(best.endpoints[0].color[c], 7);
+        writer.put(best.endpoints[1].color[c], 7);
+    }
+    writer.put(best.endpoints[0].p, 1);
+    writer.put(best.endpoints[1].p, 1);
+    writer.put(best.indices[0], 3);
+    for (size_t i = 1; i < TEXELS; ++i)
+        writer.put(best.indices[i], 4);
+}
+
+void decodeBc7(std::byte const * in, std::array<std::array<uint8_t, 4>, TEXELS> & texels) {
+    BitReader reader(in);
+    REQUIRE(reader.get(7) == 1 << 6, "Only BC7 blocks in mode 6 can be decoded");
+
+    Endpoint endpoints[2] {};
+    for (size_t c = 0; c < 4; ++c) {
+        endpoints[0].color[c] = reader.get(7);
+        endpoints[1].color[c] = reader.get(7);
+    }
+    endpoints[0].p = reader.get(1);
+    endpoints[1].p = reader.get(1);
+
+    for (size_t i = 0; i < TEXELS; ++i) {
+        size_t index = reader.get(i == 0 ? 3 : 4);
+        for (size_t c = 0; c < 4; ++c)
+            texels[i][c] = uint8_t(interpolate(endpoints[0][c], endpoints[1][c], index));
+    }
+}
+
+} // namespace
+
+Image compressed(Image const & image, Image::Format format, size_t threads) {
+    REQUIRE(!isCompressed(image.format), "Image is compressed already");
+    REQUIRE(isCompressed(format), "Images can only be compressed into a block format");
+    REQUIRE(image.width > 0 && image.height > 0, "Cannot compress an empty image");
+    // Blocks are read from 8-bit RGB or RGBA texels.
+    if (image.format != Image::Format::RGB && image.format != Image::Format::RGBA)
+        return compressed(converted(image, Image::Format::RGBA), format, threads);
+
+    Image result {
+        .width = image.width,
+        .height = image.height,
+        .format = format,
+        .image = PixelStorage(bytesOf(format, image.width, image.height)),
+    };
+    size_t blocks_x = (image.width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    size_t blocks_y = (image.height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    size_t block_bytes = result.image.size() / (blocks_x * blocks_y);
+
+    auto encode = [&](size_t block_x, size_t block_y) {
+        auto block = loadBlock(image, block_x, block_y);
+        auto * out = result.image.data() + (block_y * blocks_x + block_x) * block_bytes;
+        switch (format) {
+        case Image::Format::BC1: encodeColors(block, out); break;
+        case Image::Format::BC3: encodeChannel(block, 3, out); encodeColors(block, out + 8); break;
+        case Image::Format::BC4: encodeChannel(block, 0, out); break;
+        case Image::Format::BC7: encodeBc7(block, out); break;
+        default: assert(false && "unreachable");
+        }
+    };
+
+    // Workers take rows of blocks as they finish the previous ones.
+    std::atomic<size_t> next_row = 0;
+    auto work = [&] {
+        for (size_t row = next_row++; row < blocks_y; row = next_row++) {
+            for (size_t block_x = 0; block_x < blocks_x; ++block_x)
+                encode(block_x, row);
+        }
+    };
+
+    if (threads == 0)
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    threads = std::min(threads, blocks_y);
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 1; i < threads; ++i)
+            workers.emplace_back(work);
+        work();
+    }
+    return result;
+}
+
+Image decompressed(Image::Format format, size_t width, size_t height, std::span<std::byte const> blocks) {
+    REQUIRE(isCompressed(format), "Image is not compressed");
+    REQUIRE(blocks.size() >= bytesOf(format, width, height), "Compressed image is shorter than its blocks");
+
+    bool opaque = format == Image::Format::BC1 || format == Image::Format::BC4;
+    Image result {
+        .width = width,
+        .height = height,
+        .format = opaque ? Image::Format::RGB : Image::Format::RGBA,
+        .image = PixelStorage(width * height * (opaque ? 3 : 4)),
+    };
+    size_t channels = channelsOf(result.format);
+    size_t blocks_x = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    size_t blocks_y = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    size_t block_bytes = bytesOf(format, width, height) / (blocks_x * blocks_y);
+
+    std::array<std::array<uint8_t, 4>, TEXELS> texels;
+    for (size_t block_y = 0; block_y < blocks_y; ++block_y) {
+        for (size_t block_x = 0; block_x < blocks_x; ++block_x) {
+            auto const * in = blocks.data() + (block_y * blocks_x + block_x) * block_bytes;
+            switch (format) {
+            case Image::Format::BC1: decodeColors(in, false, texels); break;
+            case Image::Format::BC3: decodeColors(in + 8, true, texels); decodeChannel(in, 3, texels); break;
+            case Image::Format::BC4:
+                decodeChannel(in, 0, texels);
+                for (auto & texel : texels)
+                    texel[1] = texel[2] = texel[0];
+                break;
+            case Image::Format::BC7: decodeBc7(in, texels); break;
+            default: assert(false && "unreachable");
+            }
+
+            for (size_t i = 0; i < TEXELS; ++i) {
+                size_t x = block_x * BLOCK_SIZE + i % BLOCK_SIZE;
+                size_t y = block_y * BLOCK_SIZE + i / BLOCK_SIZE;
+                if (x >= width || y >= height)
+                    continue;
+                for (size_t c = 0; c < channels; ++c)
+                    result.image[(y * width + x) * channels + c] = std::byte(texels[i][c]);
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace core
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "image.h"
+
+#include <cstddef>
+#include <span>
+
+namespace core {
+
+// BC1: opaque RGB, 8 bytes per 4x4 block.
+// BC3: RGBA, a BC4 alpha block followed by a BC1 color block.
+// BC4: the first channel only, 8 bytes per block. Textures sample it as grey.
+// BC7: RGBA, 16 bytes per block. Only mode 6 is written: one pair of RGBA endpoints and 16 weights.
+
+// Encodes an RGB or RGBA image into `format`. Rows of blocks are shared out
+// between `threads` workers, 0 uses one per hardware thread.
+Image compressed(Image const & image, Image::Format format, size_t threads = 0);
+
+// Decodes blocks written by `compressed`, for drivers which cannot sample them.
+// BC1 and BC4 decode to RGB, BC3 and BC7 to RGBA.
+Image decompressed(Image::Format format, size_t width, size_t height, std::span<std::byte const> blocks);
+
+} // namespace core
@@ -1,8 +1,11 @@
 #include "drawer.h"
+#include "internal/features.h"
+#include "internal/gl_objects.h"
 #include "opengl.h"
 #include "exception.h"
 
 #include <cassert>
+#include <map>
 
 namespace core {
 
@@ -21,6 +24,14 @@ GLenum toGL(PrimitiveType type) {
     }
 }
 
+GLenum toGL(IndexType type) {
+    switch (type) {
+        case IndexType::UnsignedShort : return GL_UNSIGNED_SHORT;
+        case IndexType::UnsignedInt   : return GL_UNSIGNED_INT;
+        default: assert(false && "unreachable");
+    }
+}
+
 void checkElementsCount(PrimitiveType type, size_t count) {
     switch (type) {
         case PrimitiveType::Points:
@@ -47,6 +58,39 @@ void checkElementsCount(PrimitiveType type, size_t count) {
     }
 }
 
+constexpr GLuint VERTEX_BINDING = 0;
+
+// Every VAO switch goes through here, so redundant ones can be skipped.
+GLuint bound_vao = 0;
+
+void bindVertexArray(GLuint vao) {
+    if (vao == bound_vao)
+        return;
+    glBindVertexArray(vao);
+    bound_vao = vao;
+}
+
+// One VAO per vertex layout. They are never deleted and live as long as the GL context does.
+GLuint sharedVertexArray(Program const & program) {
+    static std::map<VertexLayout, GLuint> cache;
+
+    auto const & layout = program.vertexLayout();
+    if (auto it = cache.find(layout); it != cache.end())
+        return it->second;
+
+    GLuint vao = 0;
+    if (internal::hasDirectStateAccess()) {
+        glCreateVertexArrays(1, &vao);
+        program.enableAttributeFormats(vao, VERTEX_BINDING);
+    } else {
+        glGenVertexArrays(1, &vao);
+        bindVertexArray(vao);
+        program.enableAttributeFormats(VERTEX_BINDING);
+    }
+    cache.emplace(layout, vao);
+    return vao;
+}
+
 } // namespace
 
 
@@ -55,6 +99,11 @@ DrawerBase::DrawerBase(Program & program, VertexBuffer const & vbo, IndexBuffer
     , vbo(vbo)
     , ibo(ibo)
 {
+    if (internal::hasVertexAttribBinding()) {
+        shared_vao = sharedVertexArray(program);
+        return;
+    }
+
     glGenVertexArrays(1, &id);
 
     bind();
@@ -66,16 +115,29 @@ DrawerBase::DrawerBase(Program & program, VertexBuffer const & vbo, IndexBuffer
 }
 
 DrawerBase::~DrawerBase() {
-    // A value of 0 will be silently ignored.
-    glDeleteVertexArrays(1, &id);
+    // The VAO lives on until the GPU is done with it, it must not stay bound meanwhile.
+    if (id && bound_vao == id)
+        bindVertexArray(0);
+    internal::deleteDeferred(internal::GlObjectType::VertexArray, id);
 }
 
 void DrawerBase::bind() const {
-    glBindVertexArray(id);
+    if (!shared_vao) {
+        bindVertexArray(id);
+        return;
+    }
+
+    // The layout is already in the VAO, only the buffers change between meshes.
+    bindVertexArray(shared_vao);
+    vbo.bindVertexBuffer(VERTEX_BINDING, active_program.vertexLayout().stride);
+    if (ibo)
+        ibo->bind();
 }
 
-void DrawerBase::unbind() {
-    glBindVertexArray(0);
+void DrawerBase::unbind() const {
+    // A shared VAO stays bound for the next drawer of the same layout.
+    if (!shared_vao)
+        bindVertexArray(0);
 }
 
 void DrawerBase::draw(PrimitiveType type, size_t from, size_t size) {
@@ -86,8 +148,8 @@ void DrawerBase::draw(PrimitiveType type, size_t from, size_t size) {
     active_program.use();
 
     if (ibo) {
-        static_assert(std::is_same_v<IndexBuffer::IndexType, unsigned int>);
-        glDrawElements(toGL(type), static_cast<GLsizei>(size), GL_UNSIGNED_INT, reinterpret_cast<void*>(from * sizeof(unsigned int)));
+        auto index_type = ibo->indexType();
+        glDrawElements(toGL(type), static_cast<GLsizei>(size), toGL(index_type), reinterpret_cast<void*>(from * sizeOf(index_type)));
     } else {
         glDrawArrays(toGL(type), static_cast<GLint>(from), static_cast<GLsizei>(size));
     }
@@ -96,6 +158,59 @@ void DrawerBase::draw(PrimitiveType type, size_t from, size_t size) {
     unbind();
 }
 
+void DrawerBase::draw(PrimitiveType type, size_t from, size_t size, size_t base_vertex) {
+    REQUIRE(ibo, "Cannot draw with a base vertex: there is no index buffer");
+    checkElementsCount(type, size);
+    assert(from + size <= ibo->size());
+
+    bind();
+    active_program.use();
+
+    auto index_type = ibo->indexType();
+    glDrawElementsBaseVertex(toGL(type), static_cast<GLsizei>(size), toGL(index_type),
+        reinterpret_cast<void*>(from * sizeOf(index_type)), static_cast<GLint>(base_vertex));
+
+    active_program.disuse();
+    unbind();
+}
+
+void DrawerBase::draw(PrimitiveType type, MeshRange const & range) {
+    draw(type, range.first_index, range.index_count, range.base_vertex);
+}
+
+void DrawerBase::drawInstanced(PrimitiveType type, size_t instance_count) {
+    size_t size = ibo ? ibo->size() : vbo.size();
+    checkElementsCount(type, size);
+
+    bind();
+    active_program.use();
+
+    if (ibo) {
+        glDrawElementsInstanced(toGL(type), static_cast<GLsizei>(size), toGL(ibo->indexType()), nullptr, static_cast<GLsizei>(instance_count));
+    } else {
+        glDrawArraysInstanced(toGL(type), 0, static_cast<GLsizei>(size), static_cast<GLsizei>(instance_count));
+    }
+
+    active_program.disuse();
+    unbind();
+}
+
+void DrawerBase::drawInstanced(PrimitiveType type, MeshRange const & range, size_t instance_count) {
+    REQUIRE(ibo, "Cannot draw with a base vertex: there is no index buffer");
+    checkElementsCount(type, range.index_count);
+    assert(range.first_index + range.index_count <= ibo->size());
+
+    bind();
+    active_program.use();
+
+    auto index_type = ibo->indexType();
+    glDrawElementsInstancedBaseVertex(toGL(type), static_cast<GLsizei>(range.index_count), toGL(index_type),
+        reinterpret_cast<void*>(range.first_index * sizeOf(index_type)), static_cast<GLsizei>(instance_count), static_cast<GLint>(range.base_vertex));
+
+    active_program.disuse();
+    unbind();
+}
+
 void DrawerBase::draw(PrimitiveType type) {
     if (ibo) {
         draw(type, 0, ibo->size());
@@ -6,6 +6,7 @@
 #include "program.h"
 #include "vertex_buffer.h"
 #include "index_buffer.h"
+#include "mesh_arena.h"
 #include <functional>
 
 namespace core {
@@ -30,12 +31,22 @@ public:
 
     void draw(PrimitiveType type, size_t from, size_t size);
     void draw(PrimitiveType type);
+    // Indices of the range are relative to `base_vertex`, only drawers with an index buffer can do this.
+    void draw(PrimitiveType type, size_t from, size_t size, size_t base_vertex);
+    // Draws one mesh of a `MeshArena` page, the drawer has to be made for the buffers of that page.
+    void draw(PrimitiveType type, MeshRange const & range);
+    // Draws the whole buffer `instance_count` times, shaders tell the copies apart by gl_InstanceID.
+    void drawInstanced(PrimitiveType type, size_t instance_count);
+    void drawInstanced(PrimitiveType type, MeshRange const & range, size_t instance_count);
 
 private:
     void bind() const;
-    static void unbind();
+    void unbind() const;
 
 protected:
+    // With GL 4.3 vertex attrib binding drawers of the same vertex layout
+    // share a VAO and own none (`id` stays 0), otherwise `id` is their own one.
+    unsigned int shared_vao = 0;
     Program & active_program;
     VertexBuffer const & vbo;
     IndexBuffer const * ibo;
@@ -0,0 +1,71 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+namespace core {
+
+FrameArena::FrameArena(size_t capacity)
+    : buffer(std::make_unique<std::byte[]>(capacity))
+    , size(capacity)
+    , overflow(std::pmr::new_delete_resource())
+{}
+
+void * FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    auto base = reinterpret_cast<uintptr_t>(buffer.get());
+    auto aligned = (base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    size_t end = aligned - base + bytes;
+
+    current.bytes += bytes;
+    ++current.allocations;
+    if (end > size) {
+        current.overflow_bytes += bytes;
+        return overflow.allocate(bytes, alignment);
+    }
+
+    offset = end;
+    return reinterpret_cast<void *>(aligned);
+}
+
+void FrameArena::reset() {
+    peak = std::max(peak, offset + current.overflow_bytes);
+    if (current.overflow_bytes) {
+        // Alignment padding is not in the stats, so leave some room for it.
+        size = std::bit_ceil(peak + peak / 8);
+        buffer = std::make_unique<std::byte[]>(size);
+        overflow.release();
+    }
+
+    offset = 0;
+    last = current;
+    current = {};
+}
+
+FrameArena & frameArena() {
+    static FrameArena arena;
+    return arena;
+}
+
+namespace frame_arena {
+
+std::ostream & report(std::ostream & out) {
+    auto const & arena = frameArena();
+    auto const & last = arena.lastFrame();
+    auto kib = [](size_t bytes) { return double(bytes) / 1024.0; };
+
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "Frame arena: " << kib(arena.capacity()) << " KiB, " << kib(arena.peakBytes()) << " KiB at most, last frame "
+        << kib(last.bytes) << " KiB in " << last.allocations << " allocations, " << kib(last.overflow_bytes) << " KiB from the heap\n";
+    out.flags(flags);
+    out.precision(precision);
+    return out;
+}
+
+} // namespace frame_arena
+
+} // namespace core
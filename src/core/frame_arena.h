@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+
+namespace core {
+
+// Bump allocator for data which lives no longer than a frame. `Window::render`
+// resets it before every frame, so containers using it (through the std::pmr
+// interface) must not be kept across frames. If a frame needs more than the
+// capacity the rest comes from the heap and the arena grows at the next reset,
+// so a steady state frame does not allocate at all.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 20;
+
+    struct Stats {
+        size_t bytes = 0;
+        size_t allocations = 0;
+        // Part of `bytes` which did not fit and came from the heap.
+        size_t overflow_bytes = 0;
+    };
+
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+
+    FrameArena(FrameArena const &) = delete;
+    FrameArena & operator=(FrameArena const &) = delete;
+
+    template<class T>
+    std::span<T> allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "Frame arena never runs destructors");
+        auto * data = static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+        std::uninitialized_value_construct_n(data, count);
+        return { data, count };
+    }
+
+    // Invalidates everything allocated since the previous reset.
+    void reset();
+
+    size_t capacity() const noexcept { return size; }
+    Stats const & currentFrame() const noexcept { return current; }
+    Stats const & lastFrame() const noexcept { return last; }
+    size_t peakBytes() const noexcept { return peak; }
+
+private:
+    void * do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *, size_t, size_t) override {}
+    bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override { return this == &other; }
+
+    std::unique_ptr<std::byte[]> buffer;
+    size_t size;
+    size_t offset = 0;
+    std::pmr::monotonic_buffer_resource overflow;
+    Stats current;
+    Stats last;
+    size_t peak = 0;
+};
+
+// The arena of the frame being rendered.
+FrameArena & frameArena();
+
+namespace frame_arena {
+
+std::ostream & report(std::ostream & out);
+
+} // namespace frame_arena
+
+} // namespace core
@@ -0,0 +1,158 @@
+#include "gpu_memory.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+namespace core {
+
+namespace {
+
+struct Registry {
+    Registry() { tags.push_back({ .name = "untagged", .stats = {} }); }
+
+    size_t tagIndex(std::string_view name) {
+        auto it = std::find_if(tags.begin(), tags.end(), [&](auto const & tag) { return tag.name == name; });
+        if (it != tags.end())
+            return static_cast<size_t>(it - tags.begin());
+        tags.push_back({ .name = std::string(name), .stats = {} });
+        return tags.size() - 1;
+    }
+
+    static void grow(GpuMemoryStats & stats, size_t bytes) {
+        stats.current += bytes;
+        stats.high_water = std::max(stats.high_water, stats.current);
+    }
+
+    void count(size_t tag) {
+        ++tags[tag].stats.allocations;
+        ++total.allocations;
+    }
+
+    void add(size_t tag, size_t bytes) {
+        grow(tags[tag].stats, bytes);
+        grow(total, bytes);
+
+        bool over = budget != 0 && total.current > budget;
+        if (over && !over_budget) {
+            std::cerr << "Warning: GPU memory budget of " << budget << " bytes is exceeded by '"
+                << tags[tag].name << "', " << total.current << " bytes are in use" << std::endl;
+        }
+        over_budget = over;
+    }
+
+    void remove(size_t tag, size_t bytes) {
+        tags[tag].stats.current -= bytes;
+        total.current -= bytes;
+        over_budget = budget != 0 && total.current > budget;
+    }
+
+    std::vector<GpuMemoryTag> tags;
+    GpuMemoryStats total;
+    size_t current_tag = 0;
+    size_t budget = 0;
+    bool over_budget = false;
+};
+
+// GL objects are only touched from the thread owning the context, so there is no locking.
+// Never destroyed: static renderers release their resources after it would be.
+Registry & registry() {
+    static Registry & instance = *new Registry;
+    return instance;
+}
+
+} // namespace
+
+namespace gpu_memory {
+
+GpuMemoryStats total() {
+    return registry().total;
+}
+
+std::vector<GpuMemoryTag> const & byTag() {
+    return registry().tags;
+}
+
+void setBudget(size_t bytes) {
+    registry().budget = bytes;
+}
+
+std::ostream & report(std::ostream & out) {
+    auto const & reg = registry();
+    auto kib = [](size_t bytes) { return double(bytes) / 1024.0; };
+
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "GPU memory: " << kib(reg.total.current) << " KiB in use, " << kib(reg.total.high_water) << " KiB at most\n";
+    for (auto const & tag : reg.tags) {
+        if (tag.stats.allocations == 0)
+            continue;
+        out << "  " << tag.name << ": " << kib(tag.stats.current) << " KiB in use, "
+            << kib(tag.stats.high_water) << " KiB at most, " << tag.stats.allocations << " allocations\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+    return out;
+}
+
+ScopedTag::ScopedTag(std::string_view name)
+    : previous(registry().current_tag)
+{
+    registry().current_tag = registry().tagIndex(name);
+}
+
+ScopedTag::~ScopedTag() {
+    registry().current_tag = previous;
+}
+
+} // namespace gpu_memory
+
+namespace internal {
+
+GpuAllocation::GpuAllocation(size_t bytes)
+    : tag(registry().current_tag)
+    , size(bytes)
+{
+    if (size) {
+        auto & reg = registry();
+        reg.count(tag);
+        reg.add(tag, size);
+    }
+}
+
+GpuAllocation::~GpuAllocation() {
+    if (size)
+        registry().remove(tag, size);
+}
+
+GpuAllocation::GpuAllocation(GpuAllocation && other) noexcept
+    : tag(other.tag)
+    , size(std::exchange(other.size, 0))
+{}
+
+GpuAllocation & GpuAllocation::operator=(GpuAllocation && other) noexcept {
+    std::swap(tag, other.tag);
+    std::swap(size, other.size);
+    return *this;
+}
+
+void GpuAllocation::resize(size_t bytes) {
+    auto & reg = registry();
+    // An empty allocation is not accounted yet, it takes the tag active when it gets memory.
+    if (size == 0 && bytes > 0) {
+        tag = reg.current_tag;
+        reg.count(tag);
+    }
+    if (bytes > size) {
+        reg.add(tag, bytes - size);
+    } else {
+        reg.remove(tag, size - bytes);
+    }
+    size = bytes;
+}
+
+} // namespace internal
+
+} // namespace core
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core {
+
+struct GpuMemoryStats {
+    size_t current = 0;
+    size_t high_water = 0;
+    size_t allocations = 0;
+};
+
+struct GpuMemoryTag {
+    std::string name;
+    GpuMemoryStats stats;
+};
+
+// Book-keeping of the GPU memory owned by buffers and textures. Every
+// allocation is tagged with the renderer or subsystem active when it was made.
+namespace gpu_memory {
+
+GpuMemoryStats total();
+std::vector<GpuMemoryTag> const & byTag();
+
+// A warning is printed whenever the total goes over the budget, 0 disables it.
+void setBudget(size_t bytes);
+
+std::ostream & report(std::ostream & out);
+
+// Tags the allocations made while it is alive, tags nest.
+class ScopedTag {
+public:
+    explicit ScopedTag(std::string_view name);
+    ~ScopedTag();
+
+    ScopedTag(ScopedTag const &) = delete;
+    ScopedTag & operator=(ScopedTag const &) = delete;
+
+private:
+    size_t previous;
+};
+
+} // namespace gpu_memory
+
+namespace internal {
+
+// The accounted size of one resource, released when the resource dies.
+class GpuAllocation {
+public:
+    GpuAllocation() = default;
+    explicit GpuAllocation(size_t bytes);
+    ~GpuAllocation();
+
+    GpuAllocation(GpuAllocation const &) = delete;
+    GpuAllocation & operator=(GpuAllocation const &) = delete;
+
+    GpuAllocation(GpuAllocation && other) noexcept;
+    GpuAllocation & operator=(GpuAllocation && other) noexcept;
+
+    void resize(size_t bytes);
+    size_t bytes() const noexcept { return size; }
+
+private:
+    size_t tag = 0;
+    size_t size = 0;
+};
+
+} // namespace internal
+
+} // namespace core
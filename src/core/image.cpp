@@ -0,0 +1,362 @@
+#include "image.h"
+#include "image_kernels.h"
+#include "exception.h"
+
+#include <cassert>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace core {
+
+namespace {
+
+std::byte toByte(float value) {
+    return std::byte(static_cast<unsigned char>(std::lround(std::clamp(value, 0.0f, 255.0f))));
+}
+
+enum class Channel { Unorm8, Unorm16, Half, Float };
+
+Channel channelOf(Image::Format format) {
+    switch (format) {
+    case Image::Format::R16:
+    case Image::Format::RGBA16: return Channel::Unorm16;
+    case Image::Format::R16F:
+    case Image::Format::RGBA16F: return Channel::Half;
+    case Image::Format::R32F:
+    case Image::Format::RGBA32F: return Channel::Float;
+    default: return Channel::Unorm8;
+    }
+}
+
+size_t bytesOf(Channel channel) {
+    switch (channel) {
+    case Channel::Unorm8: return 1;
+    case Channel::Unorm16:
+    case Channel::Half: return 2;
+    case Channel::Float: return 4;
+    }
+}
+
+// Every channel of every pixel as a float, normalized formats in [0, 1].
+std::vector<float> loadValues(Image const & image) {
+    std::vector<float> values(image.width * image.height * channelsOf(image.format));
+    auto const * data = image.image.data();
+    switch (channelOf(image.format)) {
+    case Channel::Unorm8:
+        for (size_t i = 0; i < values.size(); ++i)
+            values[i] = float(std::to_integer<unsigned>(data[i])) / 255.0f;
+        break;
+    case Channel::Unorm16:
+        for (size_t i = 0; i < values.size(); ++i) {
+            uint16_t value;
+            std::memcpy(&value, data + i * 2, 2);
+            values[i] = float(value) / 65535.0f;
+        }
+        break;
+    case Channel::Half: {
+        std::vector<uint16_t> halves(values.size());
+        std::memcpy(halves.data(), data, halves.size() * 2);
+        kernels::halvesToFloats(halves, values);
+        break;
+    }
+    case Channel::Float:
+        std::memcpy(values.data(), data, values.size() * 4);
+        break;
+    }
+    return values;
+}
+
+Image storeValues(size_t width, size_t height, Image::Format format, std::span<float const> values) {
+    assert(values.size() == width * height * channelsOf(format));
+    Image image {
+        .width = width,
+        .height = height,
+        .format = format,
+        .image = PixelStorage(width * height * bytesPerPixelOf(format)),
+    };
+    auto * data = image.image.data();
+    switch (channelOf(format)) {
+    case Channel::Unorm8:
+        for (size_t i = 0; i < values.size(); ++i)
+            data[i] = toByte(values[i] * 255.0f);
+        break;
+    case Channel::Unorm16:
+        for (size_t i = 0; i < values.size(); ++i) {
+            auto value = static_cast<uint16_t>(std::lround(std::clamp(values[i], 0.0f, 1.0f) * 65535.0f));
+            std::memcpy(data + i * 2, &value, 2);
+        }
+        break;
+    case Channel::Half: {
+        std::vector<uint16_t> halves(values.size());
+        kernels::floatsToHalves(values, halves);
+        std::memcpy(data, halves.data(), halves.size() * 2);
+        break;
+    }
+    case Channel::Float:
+        std::memcpy(data, values.data(), values.size() * 4);
+        break;
+    }
+    return image;
+}
+
+// The next mip level of `channels` interleaved values.
+std::vector<float> downsampledValues(std::span<float const> values, size_t width, size_t height, size_t channels, MipFilter filter) {
+    size_t out_width = std::max<size_t>(width / 2, 1);
+    size_t out_height = std::max<size_t>(height / 2, 1);
+    std::vector<float> result(out_width * out_height * channels);
+    if (filter == MipFilter::Kaiser) {
+        kernels::kaiserDownsample(values, width, height, channels, result);
+        return result;
+    }
+    size_t row = width * channels;
+    size_t out_row = out_width * channels;
+    for (size_t y = 0; y < out_height; ++y) {
+        auto top = values.subspan(2 * y * row, row);
+        auto bottom = values.subspan(std::min(2 * y + 1, height - 1) * row, row);
+        kernels::boxDownsample(top, bottom, channels, std::span(result).subspan(y * out_row, out_row));
+    }
+    return result;
+}
+
+} // namespace
+
+PixelStorage::PixelStorage(size_t size)
+    : bytes(new std::byte[size](), &deleteArray)
+    , length(size)
+{}
+
+PixelStorage PixelStorage::adopt(std::byte * data, size_t size, Deleter deleter) noexcept {
+    PixelStorage storage;
+    storage.bytes = { data, deleter };
+    storage.length = size;
+    return storage;
+}
+
+PixelStorage::PixelStorage(PixelStorage const & other)
+    : PixelStorage(other.length)
+{
+    std::copy(other.begin(), other.end(), begin());
+}
+
+PixelStorage & PixelStorage::operator=(PixelStorage const & other) {
+    if (this != &other)
+        *this = PixelStorage(other);
+    return *this;
+}
+
+PixelStorage::PixelStorage(PixelStorage && other) noexcept
+    : bytes(std::move(other.bytes))
+    , length(std::exchange(other.length, 0))
+{}
+
+PixelStorage & PixelStorage::operator=(PixelStorage && other) noexcept {
+    if (this != &other) {
+        bytes = std::move(other.bytes);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+size_t channelsOf(Image::Format format) {
+    switch (format) {
+    case Image::Format::R8:
+    case Image::Format::R16:
+    case Image::Format::R16F:
+    case Image::Format::R32F: return 1;
+    case Image::Format::RG8: return 2;
+    case Image::Format::RGB: return 3;
+    case Image::Format::RGBA:
+    case Image::Format::RGBA16:
+    case Image::Format::RGBA16F:
+    case Image::Format::RGBA32F: return 4;
+    default: assert(false && "unreachable");
+    }
+}
+
+bool isCompressed(Image::Format format) {
+    switch (format) {
+    case Image::Format::BC1:
+    case Image::Format::BC3:
+    case Image::Format::BC4:
+    case Image::Format::BC7: return true;
+    default: return false;
+    }
+}
+
+size_t bytesPerPixelOf(Image::Format format) {
+    assert(!isCompressed(format));
+    return channelsOf(format) * bytesOf(channelOf(format));
+}
+
+size_t bytesOf(Image::Format format, size_t width, size_t height) {
+    size_t blocks = ((width + 3) / 4) * ((height + 3) / 4);
+    switch (format) {
+    case Image::Format::BC1:
+    case Image::Format::BC4: return blocks * 8;
+    case Image::Format::BC3:
+    case Image::Format::BC7: return blocks * 16;
+    default: return width * height * bytesPerPixelOf(format);
+    }
+}
+
+Image resized(Image const & image, size_t width, size_t height) {
+    assert(image.width > 0 && image.height > 0);
+    size_t channels = channelsOf(image.format);
+    auto values = loadValues(image);
+    std::vector<float> result(width * height * channels);
+
+    auto sample = [&](size_t x, size_t y, size_t c) {
+        return values[(y * image.width + x) * channels + c];
+    };
+
+    // Bilinear filter with pixel centers at half-integer coordinates.
+    float scale_x = float(image.width) / float(width);
+    float scale_y = float(image.height) / float(height);
+    for (size_t y = 0; y < height; ++y) {
+        float src_y = std::max(0.0f, (float(y) + 0.5f) * scale_y - 0.5f);
+        size_t y0 = std::min(size_t(src_y), image.height - 1);
+        size_t y1 = std::min(y0 + 1, image.height - 1);
+        float fy = src_y - float(y0);
+        for (size_t x = 0; x < width; ++x) {
+            float src_x = std::max(0.0f, (float(x) + 0.5f) * scale_x - 0.5f);
+            size_t x0 = std::min(size_t(src_x), image.width - 1);
+            size_t x1 = std::min(x0 + 1, image.width - 1);
+            float fx = src_x - float(x0);
+            for (size_t c = 0; c < channels; ++c) {
+                float top = sample(x0, y0, c) * (1 - fx) + sample(x1, y0, c) * fx;
+                float bottom = sample(x0, y1, c) * (1 - fx) + sample(x1, y1, c) * fx;
+                result[(y * width + x) * channels + c] = top * (1 - fy) + bottom * fy;
+            }
+        }
+    }
+    return storeValues(width, height, image.format, result);
+}
+
+size_t mipLevelsOf(size_t width, size_t height) {
+    return size_t(std::bit_width(std::max<size_t>({width, height, 1})));
+}
+
+Image downsampled(Image const & image, bool gamma_correct, MipFilter filter) {
+    assert(image.width > 0 && image.height > 0);
+    size_t channels = channelsOf(image.format);
+    size_t width = std::max<size_t>(image.width / 2, 1);
+    size_t height = std::max<size_t>(image.height / 2, 1);
+    // Only RGB and RGBA hold sRGB colors.
+    bool srgb = gamma_correct && (image.format == Image::Format::RGB || image.format == Image::Format::RGBA);
+
+    // Bytes holding linear values are boxed without leaving integers.
+    if (filter == MipFilter::Box && channelOf(image.format) == Channel::Unorm8 && !srgb) {
+        Image result {
+            .width = width,
+            .height = height,
+            .format = image.format,
+            .image = PixelStorage(width * height * channels),
+        };
+        size_t row = image.width * channels;
+        size_t out_row = width * channels;
+        std::span<std::byte const> pixels = image.image;
+        for (size_t y = 0; y < height; ++y) {
+            auto top = pixels.subspan(2 * y * row, row);
+            auto bottom = pixels.subspan(std::min(2 * y + 1, image.height - 1) * row, row);
+            kernels::boxDownsample(top, bottom, channels, std::span(result.image).subspan(y * out_row, out_row));
+        }
+        return result;
+    }
+
+    if (!srgb) {
+        auto values = downsampledValues(loadValues(image), image.width, image.height, channels, filter);
+        return storeValues(width, height, image.format, values);
+    }
+
+    // Colors are filtered as linear RGBA, the kernels take whole pixels.
+    Image rgba;
+    if (image.format == Image::Format::RGB)
+        rgba = converted(image, Image::Format::RGBA);
+    std::span<std::byte const> source = image.format == Image::Format::RGB ? rgba.image : image.image;
+    Image result {
+        .width = width,
+        .height = height,
+        .format = Image::Format::RGBA,
+        .image = PixelStorage(width * height * 4),
+    };
+    if (filter == MipFilter::Box) {
+        // Row by row, so that the floats stay in the cache.
+        size_t row = image.width * 4;
+        size_t out_row = width * 4;
+        std::vector<float> top(row), bottom(row), filtered(out_row);
+        for (size_t y = 0; y < height; ++y) {
+            kernels::srgbToLinear(source.subspan(2 * y * row, row), top);
+            kernels::srgbToLinear(source.subspan(std::min(2 * y + 1, image.height - 1) * row, row), bottom);
+            kernels::boxDownsample(top, bottom, 4, filtered);
+            kernels::linearToSrgb(filtered, std::span(result.image).subspan(y * out_row, out_row));
+        }
+    } else {
+        std::vector<float> linear(source.size());
+        kernels::srgbToLinear(source, linear);
+        kernels::linearToSrgb(downsampledValues(linear, image.width, image.height, 4, filter), result.image);
+    }
+    return image.format == Image::Format::RGB ? converted(result, Image::Format::RGB) : result;
+}
+
+Image converted(Image const & image, Image::Format format) {
+    REQUIRE(!isCompressed(image.format) && !isCompressed(format), "Only uncompressed images can be converted");
+    if (image.format == format)
+        return image;
+    if (image.format == Image::Format::RGB && format == Image::Format::RGBA) {
+        Image result { .width = image.width, .height = image.height, .format = format, .image = PixelStorage(image.width * image.height * 4) };
+        kernels::expandRgbToRgba(image.image, result.image);
+        return result;
+    }
+    if (image.format == Image::Format::R8 && format == Image::Format::RGBA) {
+        Image result { .width = image.width, .height = image.height, .format = format, .image = PixelStorage(image.width * image.height * 4) };
+        kernels::expandGreyToRgba(image.image, result.image);
+        return result;
+    }
+    if (image.format == Image::Format::RGBA && format == Image::Format::RGB) {
+        Image result { .width = image.width, .height = image.height, .format = format, .image = PixelStorage(image.width * image.height * 3) };
+        kernels::dropAlpha(image.image, result.image);
+        return result;
+    }
+
+    size_t from = channelsOf(image.format);
+    size_t to = channelsOf(format);
+    bool has_alpha = from == 2 || from == 4;
+    auto values = loadValues(image);
+    std::vector<float> result(image.width * image.height * to);
+    for (size_t i = 0; i < image.width * image.height; ++i) {
+        float const * src = values.data() + i * from;
+        float * dst = result.data() + i * to;
+        float alpha = has_alpha ? src[from - 1] : 1.0f;
+        if (to <= 2) {
+            // Colors become their Rec. 709 luminance.
+            dst[0] = from >= 3 ? 0.2126f * src[0] + 0.7152f * src[1] + 0.0722f * src[2] : src[0];
+        } else {
+            for (size_t c = 0; c < 3; ++c)
+                dst[c] = from >= 3 ? src[c] : src[0];
+        }
+        if (to == 2 || to == 4)
+            dst[to - 1] = alpha;
+    }
+    return storeValues(image.width, image.height, format, result);
+}
+
+Image flipped(Image const & image) {
+    REQUIRE(!isCompressed(image.format), "Only uncompressed images can be flipped");
+    Image result = image;
+    kernels::flipRows(result.image, image.width * bytesPerPixelOf(image.format));
+    return result;
+}
+
+Image premultiplied(Image const & image) {
+    REQUIRE(image.format == Image::Format::RGBA, "Only RGBA images have alpha to premultiply");
+    Image result = image;
+    kernels::premultiplyAlpha(result.image);
+    return result;
+}
+
+} // namespace core
@@ -1,17 +1,112 @@
 #pragma once
 
 #include <cstddef>
-#include <vector>
+#include <memory>
+#include <span>
 
 namespace core {
 
+// Bytes of an image. They either live on the heap or are adopted from a
+// decoder together with the function which frees them, so decoded pixels are
+// never copied on their way to the texture.
+class PixelStorage {
+public:
+    using Deleter = void (*)(std::byte *);
+
+    PixelStorage() noexcept = default;
+    // Zero-filled.
+    explicit PixelStorage(size_t size);
+    static PixelStorage adopt(std::byte * data, size_t size, Deleter deleter) noexcept;
+
+    // Copies always own heap memory.
+    PixelStorage(PixelStorage const & other);
+    PixelStorage & operator=(PixelStorage const & other);
+    // Moved from storages are empty.
+    PixelStorage(PixelStorage && other) noexcept;
+    PixelStorage & operator=(PixelStorage && other) noexcept;
+
+    std::byte * data() noexcept { return bytes.get(); }
+    std::byte const * data() const noexcept { return bytes.get(); }
+    size_t size() const noexcept { return length; }
+    bool empty() const noexcept { return length == 0; }
+
+    std::byte * begin() noexcept { return data(); }
+    std::byte * end() noexcept { return data() + length; }
+    std::byte const * begin() const noexcept { return data(); }
+    std::byte const * end() const noexcept { return data() + length; }
+
+    std::byte & operator[](size_t i) noexcept { return bytes[i]; }
+    std::byte const & operator[](size_t i) const noexcept { return bytes[i]; }
+
+private:
+    static void deleteArray(std::byte * data) noexcept { delete[] data; }
+
+    std::unique_ptr<std::byte[], Deleter> bytes { nullptr, &deleteArray };
+    size_t length = 0;
+};
+
 struct Image {
-    enum Format { RGB, RGBA };
+    // BCn formats hold 4x4 blocks of pixels, row by row, see block_compression.h.
+    // R8 to RGBA16 are unsigned normalized, 16F formats hold halves and 32F ones floats.
+    // One and two channel images are grey and grey with alpha, e.g. specular maps and masks.
+    enum Format { RGB, RGBA, BC1, BC3, BC4, BC7, R8, RG8, R16, RGBA16, R16F, RGBA16F, R32F, RGBA32F };
 
     size_t width;
     size_t height;
     Format format;
-    std::vector<std::byte> image;
+    PixelStorage image;
+};
+
+// Decoded images are immutable once shared, copying one is a reference count increment.
+using SharedImage = std::shared_ptr<Image const>;
+
+// Pixels decoded at build time by the embed tool, the base level is followed
+// by `levels - 1` mips. The pixels live in the executable, nothing is copied.
+struct BakedImage {
+    size_t width;
+    size_t height;
+    Image::Format format;
+    size_t levels;
+    std::span<std::byte const> pixels;
 };
 
+size_t channelsOf(Image::Format format);
+
+bool isCompressed(Image::Format format);
+
+// Uncompressed formats only.
+size_t bytesPerPixelOf(Image::Format format);
+
+// Size of `width` x `height` pixels, compressed formats round up to whole blocks.
+size_t bytesOf(Image::Format format, size_t width, size_t height);
+
+// Bilinearly resampled copy of the image.
+Image resized(Image const & image, size_t width, size_t height);
+
+// Number of levels in a full mip chain, down to 1x1.
+size_t mipLevelsOf(size_t width, size_t height);
+
+enum class MipFilter {
+    // Every pixel averages a 2x2 block.
+    Box,
+    // Sharper, see kernels::kaiserDownsample.
+    Kaiser,
+};
+
+// The next mip level. With `gamma_correct` the colors of RGB and RGBA images
+// are filtered as linear values and stored back as sRGB. Alpha and the other
+// formats hold linear values already.
+Image downsampled(Image const & image, bool gamma_correct, MipFilter filter = MipFilter::Box);
+
+// Copy in another uncompressed format. Grey becomes every color channel and
+// colors become grey through their luminance, a missing alpha is opaque.
+// Values are clamped to [0, 1] when stored into normalized formats.
+Image converted(Image const & image, Image::Format format);
+
+// Copy with the rows in reverse order, e.g. for GL's bottom-up textures.
+Image flipped(Image const & image);
+
+// Copy of an RGBA image with its colors multiplied by alpha, for blending with GL_ONE.
+Image premultiplied(Image const & image);
+
 } // namespace core
@@ -0,0 +1,633 @@
+#include "image_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numbers>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace core::kernels {
+
+namespace {
+
+uint32_t bitsOf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float floatOf(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Exponent and mantissa are moved into place and the exponent is rebiased by a
+// multiplication, which also normalizes denormals (after F. Giesen).
+constexpr uint32_t HALF_REBIAS = (254u - 15u) << 23;
+// Half exponents of 31 end up at or above this and are Inf or NaN.
+constexpr uint32_t HALF_INF_NAN = (127u + 16u) << 23;
+
+float halfToFloat(uint16_t half) {
+    float value = floatOf(uint32_t(half & 0x7FFFu) << 13) * floatOf(HALF_REBIAS);
+    uint32_t bits = bitsOf(value);
+    if (bits >= HALF_INF_NAN)
+        bits |= 255u << 23;
+    return floatOf(bits | (uint32_t(half & 0x8000u) << 16));
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits = bitsOf(value);
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t half;
+    if (bits >= HALF_INF_NAN) {
+        // Too big for a half, NaNs stay NaNs.
+        half = bits > (255u << 23) ? 0x7E00u : 0x7C00u;
+    } else if (bits < (113u << 23)) {
+        // A denormal half: adding the magic number rounds the mantissa in place.
+        constexpr uint32_t denormal_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+        half = bitsOf(floatOf(bits) + floatOf(denormal_magic)) - denormal_magic;
+    } else {
+        uint32_t odd = (bits >> 13) & 1u;
+        bits += ((15u - 127u) << 23) + 0xFFFu + odd;
+        half = bits >> 13;
+    }
+    return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+// sRGB bytes followed by alpha bytes, both as linear floats.
+std::array<float, 512> const & toLinearTable() {
+    static auto const table = [] {
+        std::array<float, 512> result;
+        for (size_t i = 0; i < 256; ++i) {
+            double value = double(i) / 255.0;
+            result[i] = float(value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4));
+            result[256 + i] = float(value);
+        }
+        return result;
+    }();
+    return table;
+}
+
+// Linear floats from 2^-13 up are split into 104 buckets of an eighth of an
+// exponent, and sRGB is a line within each one: the bias is in the high half
+// of an entry and the scale of the next 8 mantissa bits in the low half.
+constexpr uint32_t SRGB_MIN = (127u - 13u) << 23;
+constexpr uint32_t SRGB_ALMOST_ONE = 0x3F7FFFFFu;
+constexpr size_t SRGB_BUCKETS = 104;
+
+double linearToSrgb(double value) {
+    return value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+}
+
+std::array<uint32_t, SRGB_BUCKETS> const & toSrgbTable() {
+    static auto const table = [] {
+        std::array<uint32_t, SRGB_BUCKETS> result;
+        for (uint32_t bucket = 0; bucket < SRGB_BUCKETS; ++bucket) {
+            // Least squares fit of the rounded result, scaled by 2^16, against the mantissa bits.
+            double sum_t = 0, sum_y = 0, sum_tt = 0, sum_ty = 0, count = 0;
+            for (uint32_t t = 0; t < 256; ++t) {
+                for (uint32_t sample = 0; sample < 8; ++sample) {
+                    float value = floatOf(SRGB_MIN + (bucket << 20) + (t << 12) + (sample << 9) + 256);
+                    double y = 65536.0 * (255.0 * linearToSrgb(value) + 0.5);
+                    sum_t += t;
+                    sum_y += y;
+                    sum_tt += double(t) * t;
+                    sum_ty += t * y;
+                    count += 1;
+                }
+            }
+            double scale = (count * sum_ty - sum_t * sum_y) / (count * sum_tt - sum_t * sum_t);
+            double bias = (sum_y - scale * sum_t) / count;
+            result[bucket] = uint32_t(std::lround(bias / 512.0)) << 16 | uint32_t(std::lround(scale));
+        }
+        return result;
+    }();
+    return table;
+}
+
+std::byte toSrgb(float value, std::array<uint32_t, SRGB_BUCKETS> const & table) {
+    // Written this way NaNs end up at the bottom.
+    if (!(value > floatOf(SRGB_MIN)))
+        value = floatOf(SRGB_MIN);
+    if (value > floatOf(SRGB_ALMOST_ONE))
+        value = floatOf(SRGB_ALMOST_ONE);
+    uint32_t bits = bitsOf(value);
+    uint32_t entry = table[(bits - SRGB_MIN) >> 20];
+    uint32_t t = (bits >> 12) & 0xFFu;
+    return std::byte((((entry >> 16) << 9) + (entry & 0xFFFFu) * t) >> 16);
+}
+
+std::byte toUnorm8(float value) {
+    value = value > 0.0f ? std::min(value, 1.0f) : 0.0f;
+    return std::byte(std::lrint(value * 255.0f));
+}
+
+constexpr size_t KAISER_TAPS = 12;
+constexpr double KAISER_RADIUS = 3;
+constexpr double KAISER_BETA = 4;
+
+// Zeroth order modified Bessel function of the first kind.
+double besselI0(double x) {
+    double sum = 1;
+    double term = 1;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Source pixel 2i - 5 + k weighs kaiser[k] in destination pixel i.
+std::array<float, KAISER_TAPS> const & kaiserWeights() {
+    static auto const weights = [] {
+        std::array<double, KAISER_TAPS> taps;
+        double total = 0;
+        for (size_t k = 0; k < KAISER_TAPS; ++k) {
+            // Distance between the centers in destination pixels.
+            double x = (double(k) - 5.5) / 2;
+            double sinc = std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+            double ratio = x / KAISER_RADIUS;
+            taps[k] = sinc * besselI0(KAISER_BETA * std::sqrt(1 - ratio * ratio)) / besselI0(KAISER_BETA);
+            total += taps[k];
+        }
+        std::array<float, KAISER_TAPS> result;
+        for (size_t k = 0; k < KAISER_TAPS; ++k)
+            result[k] = float(taps[k] / total);
+        return result;
+    }();
+    return weights;
+}
+
+// Index of the k-th tap of destination pixel i in a source of `size` pixels.
+size_t kaiserTap(size_t i, size_t k, size_t size) {
+    return std::min(std::max(2 * i + k, size_t(5)) - 5, size - 1);
+}
+
+// x / 255 rounded, exact for every product of two bytes.
+unsigned divideBy255(unsigned x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+#if defined(__SSE2__)
+// Unaligned, memcpy compiles to a single move without casting the pointer.
+__m128i load(std::byte const * data) {
+    __m128i value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void store(std::byte * data, __m128i value) {
+    std::memcpy(data, &value, sizeof(value));
+}
+
+__m128 load(float const * data) {
+    __m128 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void store(float * data, __m128 value) {
+    std::memcpy(data, &value, sizeof(value));
+}
+
+// The same on eight 16-bit lanes.
+__m128i divideBy255(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// sRGB of the colors and alpha of one pixel, as 32-bit lanes.
+__m128i toSrgb(__m128 pixel, std::array<uint32_t, SRGB_BUCKETS> const & table) {
+    // The clamped value comes second so that NaNs end up at the bottom.
+    __m128 clamped = _mm_min_ps(_mm_max_ps(pixel, _mm_castsi128_ps(_mm_set1_epi32(int(SRGB_MIN)))), _mm_castsi128_ps(_mm_set1_epi32(int(SRGB_ALMOST_ONE))));
+    alignas(16) uint32_t bits[4];
+    std::memcpy(bits, &clamped, sizeof(bits));
+    __m128i entries = _mm_setr_epi32(
+        int(table[(bits[0] - SRGB_MIN) >> 20]), int(table[(bits[1] - SRGB_MIN) >> 20]),
+        int(table[(bits[2] - SRGB_MIN) >> 20]), int(table[(bits[3] - SRGB_MIN) >> 20]));
+    // Mantissa bits next to 512 make bias * 512 + scale * t a single multiply-add of 16-bit pairs.
+    __m128i t = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(_mm_castps_si128(clamped), 12), _mm_set1_epi32(0xFF)), _mm_set1_epi32(512 << 16));
+    __m128i colors = _mm_srli_epi32(_mm_madd_epi16(entries, t), 16);
+    __m128 unorm = _mm_mul_ps(_mm_min_ps(_mm_max_ps(pixel, _mm_setzero_ps()), _mm_set1_ps(1.0f)), _mm_set1_ps(255.0f));
+    __m128i alpha_lane = _mm_set_epi32(-1, 0, 0, 0);
+    return _mm_or_si128(_mm_andnot_si128(alpha_lane, colors), _mm_and_si128(alpha_lane, _mm_cvtps_epi32(unorm)));
+}
+#endif
+
+#if defined(__AVX2__)
+__m256i load256(std::byte const * data) {
+    __m256i value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void store256(std::byte * data, __m256i value) {
+    std::memcpy(data, &value, sizeof(value));
+}
+
+__m256 load256(float const * data) {
+    __m256 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void store256(float * data, __m256 value) {
+    std::memcpy(data, &value, sizeof(value));
+}
+#endif
+
+} // namespace
+
+void premultiplyAlpha(std::span<std::byte> rgba) {
+    assert(rgba.size() % 4 == 0);
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    // Two pixels per register once widened to 16 bits.
+    auto premultiply = [&](__m128i pixels) {
+        __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i colors = divideBy255(_mm_mullo_epi16(pixels, alpha));
+        return _mm_or_si128(_mm_andnot_si128(alpha_lanes, colors), _mm_and_si128(alpha_lanes, pixels));
+    };
+    for (; i + 16 <= rgba.size(); i += 16) {
+        __m128i pixels = load(rgba.data() + i);
+        __m128i low = premultiply(_mm_unpacklo_epi8(pixels, zero));
+        __m128i high = premultiply(_mm_unpackhi_epi8(pixels, zero));
+        store(rgba.data() + i, _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < rgba.size(); i += 4) {
+        auto alpha = std::to_integer<unsigned>(rgba[i + 3]);
+        for (size_t c = 0; c < 3; ++c)
+            rgba[i + c] = std::byte(divideBy255(std::to_integer<unsigned>(rgba[i + c]) * alpha));
+    }
+}
+
+void expandRgbToRgba(std::span<std::byte const> rgb, std::span<std::byte> rgba) {
+    assert(rgb.size() % 3 == 0 && rgba.size() == rgb.size() / 3 * 4);
+    size_t src = 0;
+    size_t dst = 0;
+#if defined(__SSE2__)
+    // Four pixels at a time: pixel k is shifted k bytes up into its 32-bit lane.
+    // The loads read a pixel and a third past the four, so the last ones are left to the scalar loop.
+    __m128i const lane = _mm_set_epi32(0, 0, 0, 0x00FFFFFF);
+    __m128i const alpha = _mm_set1_epi32(int(0xFF000000u));
+    for (; src + 16 <= rgb.size(); src += 12, dst += 16) {
+        __m128i pixels = load(rgb.data() + src);
+        __m128i result = _mm_or_si128(alpha, _mm_and_si128(pixels, lane));
+        result = _mm_or_si128(result, _mm_and_si128(_mm_slli_si128(pixels, 1), _mm_slli_si128(lane, 4)));
+        result = _mm_or_si128(result, _mm_and_si128(_mm_slli_si128(pixels, 2), _mm_slli_si128(lane, 8)));
+        result = _mm_or_si128(result, _mm_and_si128(_mm_slli_si128(pixels, 3), _mm_slli_si128(lane, 12)));
+        store(rgba.data() + dst, result);
+    }
+#endif
+    for (; src < rgb.size(); src += 3, dst += 4) {
+        rgba[dst] = rgb[src];
+        rgba[dst + 1] = rgb[src + 1];
+        rgba[dst + 2] = rgb[src + 2];
+        rgba[dst + 3] = std::byte(255);
+    }
+}
+
+void halvesToFloats(std::span<uint16_t const> halves, std::span<float> floats) {
+    assert(halves.size() == floats.size());
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128i const magnitude = _mm_set1_epi32(0x7FFF);
+    __m128i const inf_nan = _mm_set1_epi32(int(HALF_INF_NAN));
+    __m128i const max_exponent = _mm_set1_epi32(255 << 23);
+    __m128 const rebias = _mm_castsi128_ps(_mm_set1_epi32(int(HALF_REBIAS)));
+    for (; i + 4 <= halves.size(); i += 4) {
+        __m128i bits = _mm_setzero_si128();
+        std::memcpy(&bits, halves.data() + i, 4 * sizeof(uint16_t));
+        bits = _mm_unpacklo_epi16(bits, _mm_setzero_si128());
+        __m128i sign = _mm_slli_epi32(_mm_andnot_si128(magnitude, bits), 16);
+        __m128i value = _mm_castps_si128(_mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(bits, magnitude), 13)), rebias));
+        // Signed compare, fine as the sign bit is not set yet.
+        __m128i special = _mm_cmpgt_epi32(value, _mm_sub_epi32(inf_nan, _mm_set1_epi32(1)));
+        value = _mm_or_si128(value, _mm_and_si128(special, max_exponent));
+        __m128 result = _mm_castsi128_ps(_mm_or_si128(value, sign));
+        std::memcpy(floats.data() + i, &result, sizeof(result));
+    }
+#endif
+    for (; i < halves.size(); ++i)
+        floats[i] = halfToFloat(halves[i]);
+}
+
+void floatsToHalves(std::span<float const> floats, std::span<uint16_t> halves) {
+    assert(halves.size() == floats.size());
+    for (size_t i = 0; i < floats.size(); ++i)
+        halves[i] = floatToHalf(floats[i]);
+}
+
+void expandGreyToRgba(std::span<std::byte const> grey, std::span<std::byte> rgba) {
+    assert(rgba.size() == grey.size() * 4);
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128i const alpha = _mm_set1_epi32(int(0xFF000000u));
+    for (; i + 16 <= grey.size(); i += 16) {
+        __m128i pixels = load(grey.data() + i);
+        __m128i low = _mm_unpacklo_epi8(pixels, pixels);
+        __m128i high = _mm_unpackhi_epi8(pixels, pixels);
+        store(rgba.data() + i * 4, _mm_or_si128(alpha, _mm_unpacklo_epi16(low, low)));
+        store(rgba.data() + i * 4 + 16, _mm_or_si128(alpha, _mm_unpackhi_epi16(low, low)));
+        store(rgba.data() + i * 4 + 32, _mm_or_si128(alpha, _mm_unpacklo_epi16(high, high)));
+        store(rgba.data() + i * 4 + 48, _mm_or_si128(alpha, _mm_unpackhi_epi16(high, high)));
+    }
+#endif
+    for (; i < grey.size(); ++i) {
+        rgba[i * 4] = grey[i];
+        rgba[i * 4 + 1] = grey[i];
+        rgba[i * 4 + 2] = grey[i];
+        rgba[i * 4 + 3] = std::byte(255);
+    }
+}
+
+void dropAlpha(std::span<std::byte const> rgba, std::span<std::byte> rgb) {
+    assert(rgba.size() % 4 == 0 && rgb.size() == rgba.size() / 4 * 3);
+    size_t src = 0;
+    size_t dst = 0;
+#if defined(__SSSE3__)
+    __m128i const pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    for (; src + 16 <= rgba.size(); src += 16, dst += 12) {
+        __m128i pixels = _mm_shuffle_epi8(load(rgba.data() + src), pack);
+        std::memcpy(rgb.data() + dst, &pixels, 12);
+    }
+#endif
+    for (; src < rgba.size(); src += 4, dst += 3) {
+        rgb[dst] = rgba[src];
+        rgb[dst + 1] = rgba[src + 1];
+        rgb[dst + 2] = rgba[src + 2];
+    }
+}
+
+void swapRedBlue(std::span<std::byte> pixels) {
+    assert(pixels.size() % 4 == 0);
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256i const green_alpha_256 = _mm256_set1_epi32(int(0xFF00FF00u));
+    __m256i const low_256 = _mm256_set1_epi32(0xFF);
+    for (; i + 32 <= pixels.size(); i += 32) {
+        __m256i value = load256(pixels.data() + i);
+        __m256i red = _mm256_slli_epi32(_mm256_and_si256(value, low_256), 16);
+        __m256i blue = _mm256_and_si256(_mm256_srli_epi32(value, 16), low_256);
+        store256(pixels.data() + i, _mm256_or_si256(_mm256_and_si256(value, green_alpha_256), _mm256_or_si256(red, blue)));
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i const green_alpha = _mm_set1_epi32(int(0xFF00FF00u));
+    __m128i const low = _mm_set1_epi32(0xFF);
+    for (; i + 16 <= pixels.size(); i += 16) {
+        __m128i value = load(pixels.data() + i);
+        __m128i red = _mm_slli_epi32(_mm_and_si128(value, low), 16);
+        __m128i blue = _mm_and_si128(_mm_srli_epi32(value, 16), low);
+        store(pixels.data() + i, _mm_or_si128(_mm_and_si128(value, green_alpha), _mm_or_si128(red, blue)));
+    }
+#endif
+    for (; i < pixels.size(); i += 4)
+        std::swap(pixels[i], pixels[i + 2]);
+}
+
+void srgbToLinear(std::span<std::byte const> srgb, std::span<float> linear) {
+    assert(srgb.size() % 4 == 0 && linear.size() == srgb.size());
+    auto const & table = toLinearTable();
+    size_t i = 0;
+#if defined(__AVX2__)
+    // Alpha is looked up in the second half of the table.
+    __m256i const alpha_offset = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+    for (; i + 8 <= srgb.size(); i += 8) {
+        __m128i bytes = _mm_setzero_si128();
+        std::memcpy(&bytes, srgb.data() + i, 8);
+        __m256i indices = _mm256_add_epi32(_mm256_cvtepu8_epi32(bytes), alpha_offset);
+        store256(linear.data() + i, _mm256_i32gather_ps(table.data(), indices, 4));
+    }
+#endif
+    for (; i < srgb.size(); i += 4) {
+        linear[i] = table[std::to_integer<size_t>(srgb[i])];
+        linear[i + 1] = table[std::to_integer<size_t>(srgb[i + 1])];
+        linear[i + 2] = table[std::to_integer<size_t>(srgb[i + 2])];
+        linear[i + 3] = table[256 + std::to_integer<size_t>(srgb[i + 3])];
+    }
+}
+
+void linearToSrgb(std::span<float const> linear, std::span<std::byte> srgb) {
+    assert(linear.size() % 4 == 0 && srgb.size() == linear.size());
+    auto const & table = toSrgbTable();
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= linear.size(); i += 16) {
+        __m128i low = _mm_packs_epi32(toSrgb(load(linear.data() + i), table), toSrgb(load(linear.data() + i + 4), table));
+        __m128i high = _mm_packs_epi32(toSrgb(load(linear.data() + i + 8), table), toSrgb(load(linear.data() + i + 12), table));
+        store(srgb.data() + i, _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < linear.size(); ++i)
+        srgb[i] = i % 4 == 3 ? toUnorm8(linear[i]) : toSrgb(linear[i], table);
+}
+
+void flipRows(std::span<std::byte> pixels, size_t row_bytes) {
+    assert(row_bytes > 0 && pixels.size() % row_bytes == 0);
+    size_t rows = pixels.size() / row_bytes;
+    for (size_t row = 0; row < rows / 2; ++row) {
+        auto * top = pixels.data() + row * row_bytes;
+        auto * bottom = pixels.data() + (rows - 1 - row) * row_bytes;
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 32 <= row_bytes; i += 32) {
+            __m256i value = load256(top + i);
+            store256(top + i, load256(bottom + i));
+            store256(bottom + i, value);
+        }
+#endif
+#if defined(__SSE2__)
+        for (; i + 16 <= row_bytes; i += 16) {
+            __m128i value = load(top + i);
+            store(top + i, load(bottom + i));
+            store(bottom + i, value);
+        }
+#endif
+        std::swap_ranges(top + i, top + row_bytes, bottom + i);
+    }
+}
+
+void boxDownsample(std::span<std::byte const> top, std::span<std::byte const> bottom, size_t channels, std::span<std::byte> out) {
+    assert(top.size() == bottom.size() && top.size() % channels == 0 && out.size() % channels == 0);
+    size_t width = top.size() / channels;
+    size_t out_width = out.size() / channels;
+    assert(out_width == std::max<size_t>(width / 2, 1));
+    size_t x = 0;
+#if defined(__SSE2__)
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const half = _mm_set1_epi16(2);
+    // Sums of vertically adjacent bytes in 16-bit lanes.
+    auto sumRows = [&](size_t offset, __m128i & low, __m128i & high) {
+        __m128i t = load(top.data() + offset);
+        __m128i b = load(bottom.data() + offset);
+        low = _mm_add_epi16(_mm_unpacklo_epi8(t, zero), _mm_unpacklo_epi8(b, zero));
+        high = _mm_add_epi16(_mm_unpackhi_epi8(t, zero), _mm_unpackhi_epi8(b, zero));
+    };
+    if (channels == 4) {
+        // Four destination pixels from eight of each row.
+        for (; 2 * (x + 4) <= width; x += 4) {
+            __m128i sums[2];
+            for (size_t h = 0; h < 2; ++h) {
+                __m128i low, high;
+                sumRows(8 * x + 16 * h, low, high);
+                // Pixel 2k + 1 is the upper half of each register.
+                sums[h] = _mm_unpacklo_epi64(_mm_add_epi16(low, _mm_srli_si128(low, 8)), _mm_add_epi16(high, _mm_srli_si128(high, 8)));
+                sums[h] = _mm_srli_epi16(_mm_add_epi16(sums[h], half), 2);
+            }
+            store(out.data() + 4 * x, _mm_packus_epi16(sums[0], sums[1]));
+        }
+    } else if (channels == 1) {
+        __m128i const low_half = _mm_set1_epi32(0xFFFF);
+        for (; 2 * (x + 16) <= width; x += 16) {
+            __m128i sums[2];
+            for (size_t h = 0; h < 2; ++h) {
+                __m128i low, high;
+                sumRows(2 * x + 16 * h, low, high);
+                // Neighbouring lanes added in 32 bits, which hold at most 1020.
+                low = _mm_add_epi32(_mm_and_si128(low, low_half), _mm_srli_epi32(low, 16));
+                high = _mm_add_epi32(_mm_and_si128(high, low_half), _mm_srli_epi32(high, 16));
+                sums[h] = _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(low, high), half), 2);
+            }
+            store(out.data() + x, _mm_packus_epi16(sums[0], sums[1]));
+        }
+    }
+#endif
+    for (; x < out_width; ++x) {
+        size_t left = 2 * x * channels;
+        size_t right = std::min(2 * x + 1, width - 1) * channels;
+        for (size_t c = 0; c < channels; ++c) {
+            unsigned sum = std::to_integer<unsigned>(top[left + c]) + std::to_integer<unsigned>(top[right + c])
+                + std::to_integer<unsigned>(bottom[left + c]) + std::to_integer<unsigned>(bottom[right + c]);
+            out[x * channels + c] = std::byte((sum + 2) >> 2);
+        }
+    }
+}
+
+void boxDownsample(std::span<float const> top, std::span<float const> bottom, size_t channels, std::span<float> out) {
+    assert(top.size() == bottom.size() && top.size() % channels == 0 && out.size() % channels == 0);
+    size_t width = top.size() / channels;
+    size_t out_width = out.size() / channels;
+    assert(out_width == std::max<size_t>(width / 2, 1));
+    size_t x = 0;
+#if defined(__AVX2__)
+    if (channels == 4) {
+        __m256 const quarter_256 = _mm256_set1_ps(0.25f);
+        for (; 2 * (x + 2) <= width; x += 2) {
+            __m256 first = _mm256_add_ps(load256(top.data() + 8 * x), load256(bottom.data() + 8 * x));
+            __m256 second = _mm256_add_ps(load256(top.data() + 8 * x + 8), load256(bottom.data() + 8 * x + 8));
+            __m256 left = _mm256_permute2f128_ps(first, second, 0x20);
+            __m256 right = _mm256_permute2f128_ps(first, second, 0x31);
+            store256(out.data() + 4 * x, _mm256_mul_ps(_mm256_add_ps(left, right), quarter_256));
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    __m128 const quarter = _mm_set1_ps(0.25f);
+    if (channels == 4) {
+        for (; 2 * (x + 1) <= width; ++x) {
+            __m128 left = _mm_add_ps(load(top.data() + 8 * x), load(bottom.data() + 8 * x));
+            __m128 right = _mm_add_ps(load(top.data() + 8 * x + 4), load(bottom.data() + 8 * x + 4));
+            store(out.data() + 4 * x, _mm_mul_ps(_mm_add_ps(left, right), quarter));
+        }
+    } else if (channels == 1) {
+        for (; 2 * (x + 4) <= width; x += 4) {
+            __m128 first = _mm_add_ps(load(top.data() + 2 * x), load(bottom.data() + 2 * x));
+            __m128 second = _mm_add_ps(load(top.data() + 2 * x + 4), load(bottom.data() + 2 * x + 4));
+            __m128 left = _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 right = _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1));
+            store(out.data() + x, _mm_mul_ps(_mm_add_ps(left, right), quarter));
+        }
+    }
+#endif
+    for (; x < out_width; ++x) {
+        size_t left = 2 * x * channels;
+        size_t right = std::min(2 * x + 1, width - 1) * channels;
+        for (size_t c = 0; c < channels; ++c)
+            out[x * channels + c] = ((top[left + c] + bottom[left + c]) + (top[right + c] + bottom[right + c])) * 0.25f;
+    }
+}
+
+void kaiserDownsample(std::span<float const> pixels, size_t width, size_t height, size_t channels, std::span<float> out) {
+    assert(pixels.size() == width * height * channels);
+    size_t out_width = std::max<size_t>(width / 2, 1);
+    size_t out_height = std::max<size_t>(height / 2, 1);
+    assert(out.size() == out_width * out_height * channels);
+    auto const & weights = kaiserWeights();
+
+    // Columns first, over whole rows at once. A single row or column is kept as it is.
+    size_t row_size = width * channels;
+    std::vector<float> columns;
+    if (height > 1) {
+        columns.resize(row_size * out_height);
+        for (size_t y = 0; y < out_height; ++y) {
+            float * dst = columns.data() + y * row_size;
+            for (size_t k = 0; k < KAISER_TAPS; ++k) {
+                float const * src = pixels.data() + kaiserTap(y, k, height) * row_size;
+                float weight = weights[k];
+                size_t i = 0;
+#if defined(__AVX2__)
+                __m256 weight_256 = _mm256_set1_ps(weight);
+                for (; i + 8 <= row_size; i += 8)
+                    store256(dst + i, _mm256_add_ps(load256(dst + i), _mm256_mul_ps(load256(src + i), weight_256)));
+#endif
+#if defined(__SSE2__)
+                __m128 weight_128 = _mm_set1_ps(weight);
+                for (; i + 4 <= row_size; i += 4)
+                    store(dst + i, _mm_add_ps(load(dst + i), _mm_mul_ps(load(src + i), weight_128)));
+#endif
+                for (; i < row_size; ++i)
+                    dst[i] += src[i] * weight;
+            }
+        }
+    }
+    std::span<float const> rows = height > 1 ? std::span<float const>(columns) : pixels;
+
+    for (size_t y = 0; y < out_height; ++y) {
+        float const * src = rows.data() + y * row_size;
+        float * dst = out.data() + y * out_width * channels;
+        if (width == 1) {
+            std::copy_n(src, channels, dst);
+            continue;
+        }
+        for (size_t x = 0; x < out_width; ++x) {
+#if defined(__SSE2__)
+            if (channels == 4) {
+                __m128 sum = _mm_setzero_ps();
+                for (size_t k = 0; k < KAISER_TAPS; ++k)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(load(src + kaiserTap(x, k, width) * 4), _mm_set1_ps(weights[k])));
+                store(dst + x * 4, sum);
+                continue;
+            }
+#endif
+            for (size_t c = 0; c < channels; ++c) {
+                float sum = 0;
+                for (size_t k = 0; k < KAISER_TAPS; ++k)
+                    sum += src[kaiserTap(x, k, width) * channels + c] * weights[k];
+                dst[x * channels + c] = sum;
+            }
+        }
+    }
+}
+
+} // namespace core::kernels
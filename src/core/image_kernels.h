@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Loops over whole rows of pixels, vectorised with SSE2 where it is available
+// and with AVX2 where the build targets it (see NATIVE_ARCH in CMakeLists.txt).
+// Integer kernels give the same results as their scalar versions bit for bit,
+// float ones up to the rounding of sums taken in another order.
+namespace core::kernels {
+
+// Multiplies the colors of RGBA pixels by their alpha, rounded to the nearest value.
+void premultiplyAlpha(std::span<std::byte> rgba);
+
+// Appends an opaque alpha to every RGB pixel, `rgba` holds a third more bytes.
+void expandRgbToRgba(std::span<std::byte const> rgb, std::span<std::byte> rgba);
+
+// Replicates grey into the colors of opaque RGBA pixels.
+void expandGreyToRgba(std::span<std::byte const> grey, std::span<std::byte> rgba);
+
+// Drops the alpha of every RGBA pixel, `rgb` holds a quarter fewer bytes.
+void dropAlpha(std::span<std::byte const> rgba, std::span<std::byte> rgb);
+
+// RGBA to BGRA and back.
+void swapRedBlue(std::span<std::byte> pixels);
+
+// IEEE half precision values to floats, every half is represented exactly.
+void halvesToFloats(std::span<uint16_t const> halves, std::span<float> floats);
+
+// Rounded to the nearest even half, values out of range become infinity.
+void floatsToHalves(std::span<float const> floats, std::span<uint16_t> halves);
+
+// RGBA pixels between sRGB bytes and linear floats in [0, 1], alpha is linear in both.
+// Bytes are looked up in a table, floats are clamped and come back within 0.544
+// of the exact value (after F. Giesen's piecewise linear approximation).
+void srgbToLinear(std::span<std::byte const> srgb, std::span<float> linear);
+void linearToSrgb(std::span<float const> linear, std::span<std::byte> srgb);
+
+// Swaps row i with row rows - 1 - i.
+void flipRows(std::span<std::byte> pixels, size_t row_bytes);
+
+// One row of the next mip level: pixel i averages pixels 2i and 2i + 1 of
+// `top` and `bottom`, the last one is repeated when the width is odd.
+// Bytes are rounded to the nearest value.
+void boxDownsample(std::span<std::byte const> top, std::span<std::byte const> bottom, size_t channels, std::span<std::byte> out);
+void boxDownsample(std::span<float const> top, std::span<float const> bottom, size_t channels, std::span<float> out);
+
+// The next mip level through a Kaiser windowed sinc, which keeps more detail
+// than a box without aliasing. It reaches three destination pixels each way,
+// edges are clamped and lobes may overshoot [0, 1].
+void kaiserDownsample(std::span<float const> pixels, size_t width, size_t height, size_t channels, std::span<float> out);
+
+} // namespace core::kernels
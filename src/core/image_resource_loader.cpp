@@ -1,55 +1,267 @@
 #include "image_resource_loader.h"
+#include "thread_pool.h"
 
 #include <SOIL/SOIL.h>
 
 #include <cassert>
 #include <span>
 #include <cstdint>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
 
 using BytesBufferView = std::span<const uint8_t>;
 namespace core {
 
+namespace resources {
+#include <resources/img/wood_container.h>
+#include <resources/img/awesomeface.h>
+#include <resources/img/container2.h>
+#include <resources/img/container2_specular.h>
+#include <resources/img/wood_container.baked.h>
+#include <resources/img/awesomeface.baked.h>
+#include <resources/img/container2.baked.h>
+#include <resources/img/container2_specular.baked.h>
+#include <resources/img/wood_and_face.baked.h>
+} // namespace resources
+
 namespace {
 Image::Format toFormat(int channels) {
     switch (channels) {
+    case 1: return Image::Format::R8;
+    case 2: return Image::Format::RG8;
     case 3: return Image::Format::RGB;
     case 4: return Image::Format::RGBA;
     default: assert(false && "wrong channels");
     }
 }
 
+// SOIL writes its last result to a global on every load and has no reentrant
+// entry point, so images loaded on the worker pool are decoded one at a time.
+std::mutex & soilMutex() {
+    static std::mutex & mutex = *new std::mutex;
+    return mutex;
+}
+
+void freeSoilImage(std::byte * data) noexcept {
+    SOIL_free_image_data(reinterpret_cast<unsigned char*>(data));
+}
+
+// The image takes over the buffer SOIL decoded into.
 Image load(BytesBufferView buffer) {
     int w, h, channels;
-    auto* data = SOIL_load_image_from_memory(buffer.data(), (int)buffer.size(), &w, &h, &channels, SOIL_LOAD_AUTO);
+    unsigned char * data;
+    {
+        std::lock_guard lock(soilMutex());
+        data = SOIL_load_image_from_memory(buffer.data(), (int)buffer.size(), &w, &h, &channels, SOIL_LOAD_AUTO);
+    }
     assert(data && "cannot load image data");
-    std::span<std::byte> dataView(reinterpret_cast<std::byte*>(data), size_t(w * h * channels));
-    Image img {
+    return {
         .width = static_cast<size_t>(w),
         .height = static_cast<size_t>(h),
         .format = toFormat(channels),
-        .image = {dataView.begin(), dataView.end()}
+        .image = PixelStorage::adopt(reinterpret_cast<std::byte*>(data), size_t(w * h * channels), &freeSoilImage),
+    };
+}
+
+BakedImage baked(size_t width, size_t height, Image::Format format, size_t levels, std::span<unsigned char const> pixels) {
+    return {
+        .width = width,
+        .height = height,
+        .format = format,
+        .levels = levels,
+        .pixels = std::as_bytes(pixels),
+    };
+}
+// Regions are the top-left texel, width and height of every image in the page.
+BakedAtlas bakedAtlas(BakedImage page, std::span<size_t const[4]> regions) {
+    BakedAtlas atlas { .page = page, .regions = {} };
+    for (auto const & region : regions)
+        atlas.regions.push_back(atlasRegion(region[0], region[1], region[2], region[3], page.width, page.height, 0));
+    return atlas;
+}
+
+// Straight from the executable's read-only data.
+Image decode(ImgResources res) {
+    using namespace resources;
+    switch (res) {
+    case ImgResources::WoodContainer: return load(BytesBufferView(wood_container_data, wood_container_data_size));
+    case ImgResources::AwesomeFace: return load(BytesBufferView(awesomeface_data, awesomeface_data_size));
+    case ImgResources::Container2: return load(BytesBufferView(container2_data, container2_data_size));
+    case ImgResources::Container2_specular: return load(BytesBufferView(container2_specular_data, container2_specular_data_size));
+    }
+}
+
+class ImageCache {
+public:
+    SharedImage find(ImgResources res) {
+        std::lock_guard lock(mutex);
+        auto it = entries.find(res);
+        if (it == entries.end())
+            return nullptr;
+        auto image = it->second.image.lock();
+        if (!image)
+            return nullptr;
+        ++statistics.hits;
+        touch(it->second, image);
+        return image;
+    }
+
+    // Another thread may have decoded the same image meanwhile, the first one is kept.
+    SharedImage insert(ImgResources res, SharedImage image) {
+        std::lock_guard lock(mutex);
+        auto & entry = entries[res];
+        if (auto cached = entry.image.lock()) {
+            ++statistics.hits;
+            touch(entry, cached);
+            return cached;
+        }
+        ++statistics.misses;
+        entry.image = image;
+        entry.bytes = image->image.size();
+        touch(entry, image);
+        return image;
+    }
+
+    ImageCacheStats stats() {
+        std::lock_guard lock(mutex);
+        return statistics;
+    }
+
+    void setCapacity(size_t bytes) {
+        std::lock_guard lock(mutex);
+        capacity = bytes;
+        trim();
+    }
+
+    void clear() {
+        std::lock_guard lock(mutex);
+        for (auto & [res, entry] : entries)
+            release(entry);
+    }
+
+private:
+    struct Entry {
+        std::weak_ptr<Image const> image;
+        // Set while the cache itself keeps the image alive.
+        SharedImage pinned;
+        size_t bytes = 0;
+        size_t last_use = 0;
     };
-    SOIL_free_image_data(data);
-    return img;
+
+    void touch(Entry & entry, SharedImage const & image) {
+        entry.last_use = ++clock;
+        if (!entry.pinned) {
+            entry.pinned = image;
+            statistics.bytes += entry.bytes;
+        }
+        trim();
+    }
+
+    void release(Entry & entry) {
+        if (!entry.pinned)
+            return;
+        entry.pinned.reset();
+        statistics.bytes -= entry.bytes;
+        ++statistics.evictions;
+    }
+
+    void trim() {
+        while (statistics.bytes > capacity) {
+            Entry * oldest = nullptr;
+            for (auto & [res, entry] : entries) {
+                if (entry.pinned && (!oldest || entry.last_use < oldest->last_use))
+                    oldest = &entry;
+            }
+            release(*oldest);
+        }
+    }
+
+    std::mutex mutex;
+    std::map<ImgResources, Entry> entries;
+    ImageCacheStats statistics;
+    size_t capacity = size_t(64) << 20;
+    size_t clock = 0;
+};
+
+// Never destroyed: static renderers may still hold images when it would be.
+ImageCache & cache() {
+    static ImageCache & instance = *new ImageCache;
+    return instance;
 }
+
 } // namespace
 
+SharedImage loadResource(ImgResources res) {
+    if (auto image = cache().find(res))
+        return image;
+    // Decoded without holding the lock, so that other images can be loaded meanwhile.
+    return cache().insert(res, std::make_shared<Image const>(decode(res)));
+}
 
-Image loadResource(ImgResources res) {
+std::vector<std::future<SharedImage>> loadResources(std::span<ImgResources const> resources, ImagePostProcess post) {
+    std::vector<std::future<SharedImage>> images;
+    images.reserve(resources.size());
+    for (auto res : resources) {
+        images.push_back(workerPool().submit([res, post]() -> SharedImage {
+            auto image = loadResource(res);
+            if (!post)
+                return image;
+            return std::make_shared<Image const>(post(*image));
+        }));
+    }
+    return images;
+}
+
+BakedImage bakedResource(ImgResources res) {
+    using namespace resources;
     switch (res) {
-    case ImgResources::WoodContainer: return load(BytesBufferView({
-        #include <resources/img/wood_container.h>
-    }));
-    case ImgResources::AwesomeFace: return load(BytesBufferView({
-        #include <resources/img/awesomeface.h>
-    }));
-    case ImgResources::Container2: return load(BytesBufferView({
-        #include <resources/img/container2.h>
-    }));
-    case ImgResources::Container2_specular: return load(BytesBufferView({
-        #include <resources/img/container2_specular.h>
-    }));
+    case ImgResources::WoodContainer:
+        return baked(wood_container_width, wood_container_height, wood_container_format, wood_container_levels, { wood_container_pixels, wood_container_pixels_size });
+    case ImgResources::AwesomeFace:
+        return baked(awesomeface_width, awesomeface_height, awesomeface_format, awesomeface_levels, { awesomeface_pixels, awesomeface_pixels_size });
+    case ImgResources::Container2:
+        return baked(container2_width, container2_height, container2_format, container2_levels, { container2_pixels, container2_pixels_size });
+    case ImgResources::Container2_specular:
+        return baked(container2_specular_width, container2_specular_height, container2_specular_format, container2_specular_levels, { container2_specular_pixels, container2_specular_pixels_size });
     }
 }
 
+BakedAtlas bakedResource(AtlasResources res) {
+    using namespace resources;
+    switch (res) {
+    case AtlasResources::WoodAndFace:
+        return bakedAtlas(baked(wood_and_face_width, wood_and_face_height, wood_and_face_format, wood_and_face_levels, { wood_and_face_pixels, wood_and_face_pixels_size }), wood_and_face_regions);
+    }
+}
+
+namespace image_cache {
+
+ImageCacheStats stats() {
+    return cache().stats();
+}
+
+void setCapacity(size_t bytes) {
+    cache().setCapacity(bytes);
+}
+
+void clear() {
+    cache().clear();
+}
+
+std::ostream & report(std::ostream & out) {
+    auto current = stats();
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "Image cache: " << double(current.bytes) / 1024.0 << " KiB cached, "
+        << current.hits << " hits, " << current.misses << " misses, " << current.evictions << " evictions\n";
+    out.flags(flags);
+    out.precision(precision);
+    return out;
+}
+
+} // namespace image_cache
+
 } // namespace core
@@ -1,7 +1,15 @@
 #pragma once
 
+#include "atlas_packing.h"
 #include "image.h"
 
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
 namespace core {
 
 enum class ImgResources {
@@ -11,6 +19,48 @@ enum class ImgResources {
     Container2_specular,
 };
 
-Image loadResource(ImgResources res);
+// Atlases of several images, packed at build time.
+enum class AtlasResources {
+    // Regions 0 and 1 are the wood container and the awesome face.
+    WoodAndFace,
+};
+
+// Decodes the image the first time, later calls share it while it is cached or in use.
+SharedImage loadResource(ImgResources res);
+
+// Runs on the worker right after decoding, e.g. `premultiplied`.
+using ImagePostProcess = std::function<Image(Image const &)>;
+
+// Loads the images on the worker pool. SOIL keeps global state, so decoding is
+// serialised and takes as long as decoding the images one after another; only
+// post-processing and the caller's own work overlap with it. Post-processed
+// images are new ones, only the decoded originals are cached.
+std::vector<std::future<SharedImage>> loadResources(std::span<ImgResources const> resources, ImagePostProcess post = {});
+
+// The same images decoded and mipmapped at build time.
+BakedImage bakedResource(ImgResources res);
+BakedAtlas bakedResource(AtlasResources res);
+
+struct ImageCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    // Decoded pixels kept alive by the cache itself.
+    size_t bytes = 0;
+};
+
+// The images behind `loadResource`. The cache keeps up to its capacity of the
+// most recently used images alive, others live as long as their users do.
+namespace image_cache {
+
+ImageCacheStats stats();
+
+// Least recently used images are released first when it is exceeded.
+void setCapacity(size_t bytes);
+void clear();
+
+std::ostream & report(std::ostream & out);
+
+} // namespace image_cache
 
 } // namespace core
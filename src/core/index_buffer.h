@@ -2,17 +2,37 @@
 
 #include "internal/buffer.h"
 
+#include <cstdint>
+#include <type_traits>
+
 namespace core {
 
+enum class IndexType { UnsignedShort, UnsignedInt };
+
+template<class T>
+consteval IndexType indexTypeOf() {
+    static_assert(std::is_same_v<T, uint16_t> || std::is_same_v<T, uint32_t>, "Unsupported index type");
+    return std::is_same_v<T, uint16_t> ? IndexType::UnsignedShort : IndexType::UnsignedInt;
+}
+
+constexpr size_t sizeOf(IndexType type) noexcept {
+    return type == IndexType::UnsignedShort ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
 class IndexBuffer : public internal::Buffer<internal::BufferType::Index> {
 public:
     DEFAULT_MOVABLE(IndexBuffer);
 
-    using IndexType = unsigned int;
-
-    IndexBuffer(IndexType const * data, size_t number_of_elements, BufferUsage usage)
-        : Buffer(reinterpret_cast<std::byte const *>(data), number_of_elements, sizeof(IndexType), usage)
+    template<class T>
+    IndexBuffer(T const * data, size_t number_of_elements, BufferUsage usage)
+        : Buffer(reinterpret_cast<std::byte const *>(data), number_of_elements, sizeof(T), usage)
+        , index_type(indexTypeOf<T>())
     {}
+
+    IndexType indexType() const noexcept { return index_type; }
+
+private:
+    IndexType index_type;
 };
 
 } // namespace core
@@ -1,12 +1,22 @@
 #pragma once
 
+#include "mesh_optimizer.h"
+
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 
 namespace core {
 
-struct Indexer {
-    using IndexType = unsigned int;
+// The narrowest index type which can address `vertex_count` vertices.
+template<size_t vertex_count>
+using IndexFor = std::conditional_t<(vertex_count <= size_t(std::numeric_limits<uint16_t>::max()) + 1), uint16_t, uint32_t>;
+
+template<class Index>
+struct BasicIndexer {
+    using IndexType = Index;
 
     void addTriangle(IndexType a, IndexType b, IndexType c) {
         indices.push_back(a);
@@ -23,11 +33,22 @@ struct Indexer {
         addQuad(0, 1, 2, 3);
     }
 
+    // Reorders the triangles and the given vertices for the post-transform cache and vertex fetch.
+    // Vertices which are not referenced by any triangle are moved past `vertex_count_after`.
+    template<class Vertex, size_t extent>
+    MeshOptimizationReport optimize(std::span<Vertex, extent> vertices) {
+        return optimizeMesh(std::span<Vertex>(vertices), std::span<IndexType>(indices));
+    }
+
     IndexType * data() { return indices.data(); }
     size_t size() { return indices.size(); }
 
     std::vector<IndexType> indices;
 };
 
+using Indexer = BasicIndexer<uint32_t>;
+
+template<size_t vertex_count>
+using IndexerFor = BasicIndexer<IndexFor<vertex_count>>;
 
 } // namespace core
@@ -1,4 +1,5 @@
 #include "buffer.h"
+#include "features.h"
 #include "../opengl.h"
 
 #include <cassert>
@@ -14,6 +15,16 @@ GLenum toGL(BufferUsage type) {
     }
 }
 
+GLbitfield toGL(MapAccess access) {
+    GLbitfield flags = 0;
+    if (access & MapAccess::Read)             flags |= GL_MAP_READ_BIT;
+    if (access & MapAccess::Write)            flags |= GL_MAP_WRITE_BIT;
+    if (access & MapAccess::InvalidateRange)  flags |= GL_MAP_INVALIDATE_RANGE_BIT;
+    if (access & MapAccess::InvalidateBuffer) flags |= GL_MAP_INVALIDATE_BUFFER_BIT;
+    if (access & MapAccess::Unsynchronized)   flags |= GL_MAP_UNSYNCHRONIZED_BIT;
+    return flags;
+}
+
 namespace internal {
 
 template<BufferType type>
@@ -28,17 +39,19 @@ consteval GLenum toGL() {
 template<BufferType type>
 Buffer<type>::Buffer(const std::byte* data, size_t number_of_elements, size_t element_size, BufferUsage usage)
     : number_of_elements(number_of_elements)
+    , element_size(element_size)
+    , usage(usage)
+    , memory(number_of_elements * element_size)
 {
-    glGenBuffers(1, &id);
+    if (hasDirectStateAccess()) {
+        glCreateBuffers(1, &id);
+    } else {
+        glGenBuffers(1, &id);
+    }
+    entry = { bufferPool(), id, { number_of_elements * element_size } };
     load(data, number_of_elements * element_size, usage);
 }
 
-template<BufferType type>
-Buffer<type>::~Buffer() {
-    // A value of 0 will be silently ignored.
-    glDeleteBuffers(1, &id);
-}
-
 template<BufferType type>
 void Buffer<type>::bind() const {
     glBindBuffer(toGL<type>(), id);
@@ -49,12 +62,77 @@ void Buffer<type>::unbind() {
     glBindBuffer(toGL<type>(), 0);
 }
 
+template<BufferType type>
+void Buffer<type>::bindVertexBuffer(unsigned int binding, size_t stride) const {
+    glBindVertexBuffer(binding, id, 0, static_cast<GLsizei>(stride));
+}
+
+template<BufferType type>
+void Buffer<type>::copyTo(Buffer & target, size_t from, size_t to, size_t size) const {
+    if (hasDirectStateAccess()) {
+        glCopyNamedBufferSubData(id, target.id, static_cast<GLintptr>(from), static_cast<GLintptr>(to), static_cast<GLsizeiptr>(size));
+        return;
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, id);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, target.id);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+        static_cast<GLintptr>(from), static_cast<GLintptr>(to), static_cast<GLsizeiptr>(size));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
 template<BufferType type>
 void Buffer<type>::load(const std::byte* data, size_t size, BufferUsage usage) {
+    if (hasDirectStateAccess()) {
+        glNamedBufferData(id, static_cast<GLsizeiptr>(size), data, toGL(usage));
+        return;
+    }
+
     bind();
     glBufferData(toGL<type>(), static_cast<GLsizeiptr>(size), data, toGL(usage));
 }
 
+template<BufferType type>
+void Buffer<type>::updateBytes(size_t offset, std::span<std::byte const> data) {
+    if (hasDirectStateAccess()) {
+        glNamedBufferSubData(id, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(data.size()), data.data());
+        return;
+    }
+
+    bind();
+    glBufferSubData(toGL<type>(), static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(data.size()), data.data());
+}
+
+template<BufferType type>
+void Buffer<type>::orphan() {
+    // Same size and usage with no data lets the driver hand out a fresh block.
+    load(nullptr, number_of_elements * element_size, usage);
+}
+
+template<BufferType type>
+void * Buffer<type>::mapBytes(size_t offset, size_t size, MapAccess access) {
+    REQUIRE(access & (MapAccess::Read | MapAccess::Write), "Buffer should be mapped for reading or writing");
+    void * data = nullptr;
+    if (hasDirectStateAccess()) {
+        data = glMapNamedBufferRange(id, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), toGL(access));
+    } else {
+        bind();
+        data = glMapBufferRange(toGL<type>(), static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), toGL(access));
+    }
+    REQUIRE(data, "Cannot map buffer range");
+    return data;
+}
+
+template<BufferType type>
+bool Buffer<type>::unmap() {
+    if (hasDirectStateAccess())
+        return glUnmapNamedBuffer(id) == GL_TRUE;
+
+    bind();
+    return glUnmapBuffer(toGL<type>()) == GL_TRUE;
+}
+
 template class Buffer<BufferType::Vertex>;
 template class Buffer<BufferType::Index>;
 
@@ -1,8 +1,12 @@
 #pragma once
 
+#include "gl_objects.h"
 #include "resource.h"
 #include "movable.h"
+#include "../exception.h"
+#include "../gpu_memory.h"
 #include <cstddef>
+#include <span>
 
 namespace core {
 
@@ -12,6 +16,24 @@ enum class BufferUsage {
     StreamDraw
 };
 
+enum class MapAccess : unsigned int {
+    Read             = 1 << 0,
+    Write            = 1 << 1,
+    // The mapped range may be discarded, nothing has to be read back.
+    InvalidateRange  = 1 << 2,
+    InvalidateBuffer = 1 << 3,
+    // No waiting for draws still reading the buffer, the caller must not overwrite what they use.
+    Unsynchronized   = 1 << 4,
+};
+
+constexpr MapAccess operator|(MapAccess lhs, MapAccess rhs) noexcept {
+    return static_cast<MapAccess>(static_cast<unsigned int>(lhs) | static_cast<unsigned int>(rhs));
+}
+
+constexpr bool operator&(MapAccess lhs, MapAccess rhs) noexcept {
+    return (static_cast<unsigned int>(lhs) & static_cast<unsigned int>(rhs)) != 0;
+}
+
 namespace internal {
 
 enum class BufferType { Vertex, Index };
@@ -23,16 +45,62 @@ public:
 
     Buffer(const std::byte* data, size_t number_of_elements, size_t element_size, BufferUsage usage);
 
-    ~Buffer();
-
     void bind() const;
     static void unbind();
 
+    // GL 4.3 vertex attrib binding: attaches the buffer to `binding` of the bound VAO.
+    void bindVertexBuffer(unsigned int binding, size_t stride) const;
+
+    // Copies bytes on the GPU. `target` may be this very buffer as long as the ranges do not overlap.
+    void copyTo(Buffer & target, size_t from, size_t to, size_t size) const;
+
+    // Overwrites the elements starting from `offset`, `data` has to cover whole elements.
+    template<class T>
+    void update(size_t offset, std::span<T const> data) {
+        REQUIRE(data.size_bytes() % element_size == 0, "Buffer update should cover whole elements");
+        REQUIRE(offset + data.size_bytes() / element_size <= number_of_elements, "Buffer update is out of range");
+        updateBytes(offset * element_size, std::as_bytes(data));
+    }
+
+    // Detaches the storage from draws which still read it, so the next writes do not wait for them.
+    void orphan();
+
+    // Orphans the storage and fills the new one with `data`, which may have a different number of elements.
+    template<class T>
+    void assign(std::span<T const> data) {
+        REQUIRE(data.size_bytes() % element_size == 0, "Buffer data should cover whole elements");
+        number_of_elements = data.size_bytes() / element_size;
+        memory.resize(data.size_bytes());
+        entry.meta().bytes = data.size_bytes();
+        load(reinterpret_cast<std::byte const *>(data.data()), data.size_bytes(), usage);
+    }
+
+    // Maps `count` elements starting from `offset` until `unmap` is called.
+    template<class T>
+    std::span<T> mapRange(size_t offset, size_t count, MapAccess access = MapAccess::Write) {
+        REQUIRE(offset + count <= number_of_elements, "Mapped range is out of the buffer");
+        size_t size = count * element_size;
+        REQUIRE(size % sizeof(T) == 0, "Mapped range does not hold whole values of the requested type");
+        return { static_cast<T *>(mapBytes(offset * element_size, size, access)), size / sizeof(T) };
+    }
+
+    // Returns false if the storage was lost while mapped and has to be uploaded again.
+    bool unmap();
+
     size_t size() const noexcept { return number_of_elements; }
+    BufferPool::Handle handle() const noexcept { return entry.handle(); }
 
 private:
     void load(const std::byte* data, size_t total_size, BufferUsage usage);
+    void updateBytes(size_t offset, std::span<std::byte const> data);
+    void * mapBytes(size_t offset, size_t size, MapAccess access);
+
     size_t number_of_elements;
+    size_t element_size;
+    BufferUsage usage;
+    GpuAllocation memory;
+    // Owns the buffer, `id` is its name.
+    PoolEntry<BufferInfo> entry;
 };
 
 } // namespace internal
@@ -0,0 +1,38 @@
+#include "features.h"
+#include "../opengl.h"
+
+namespace core::internal {
+
+bool hasDirectStateAccess() {
+    return GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access;
+}
+
+bool hasVertexAttribBinding() {
+    return GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding;
+}
+
+bool hasBufferStorage() {
+    return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
+
+bool hasTextureStorage() {
+    return GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+}
+
+bool hasAnisotropicFiltering() {
+    return GLEW_EXT_texture_filter_anisotropic || GLEW_ARB_texture_filter_anisotropic;
+}
+
+bool hasS3tcCompression() {
+    return GLEW_EXT_texture_compression_s3tc;
+}
+
+bool hasBptcCompression() {
+    return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+}
+
+bool hasSrgbS3tcCompression() {
+    return GLEW_EXT_texture_compression_s3tc && GLEW_EXT_texture_sRGB;
+}
+
+} // namespace core::internal
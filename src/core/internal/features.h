@@ -0,0 +1,24 @@
+#pragma once
+
+namespace core::internal {
+
+// Optional GL features which have a faster code path, valid once GLEW is initialized.
+
+// GL 4.5: objects are created and edited by name, without binding them.
+bool hasDirectStateAccess();
+// GL 4.3: vertex formats are separate from the buffers they are read from.
+bool hasVertexAttribBinding();
+// GL 4.4: immutable buffer storage which can stay mapped.
+bool hasBufferStorage();
+// GL 4.2: immutable texture storage, every level is allocated and validated once.
+bool hasTextureStorage();
+// GL 4.6 or EXT_texture_filter_anisotropic.
+bool hasAnisotropicFiltering();
+// EXT_texture_compression_s3tc: BC1 to BC3 blocks, which are not core in any version.
+bool hasS3tcCompression();
+// GL 4.2: BC6H and BC7 blocks.
+bool hasBptcCompression();
+// EXT_texture_sRGB: sRGB variants of the S3TC formats.
+bool hasSrgbS3tcCompression();
+
+} // namespace core::internal
@@ -0,0 +1,93 @@
+#include "gl_objects.h"
+#include "../opengl.h"
+
+#include <cassert>
+#include <deque>
+#include <vector>
+
+namespace core::internal {
+
+namespace {
+
+struct DeadObject {
+    GlObjectType type;
+    GLuint id;
+};
+
+struct DeadFrame {
+    std::vector<DeadObject> objects;
+    GLsync fence;
+};
+
+struct DeletionQueue {
+    std::vector<DeadObject> current;
+    std::deque<DeadFrame> pending;
+};
+
+// Never destroyed: static renderers release their resources after it would be.
+DeletionQueue & deletionQueue() {
+    static DeletionQueue & queue = *new DeletionQueue;
+    return queue;
+}
+
+void deleteNow(DeadObject const & object) {
+    switch (object.type) {
+        case GlObjectType::Buffer      : glDeleteBuffers(1, &object.id); break;
+        case GlObjectType::Texture     : glDeleteTextures(1, &object.id); break;
+        case GlObjectType::VertexArray : glDeleteVertexArrays(1, &object.id); break;
+        default: assert(false && "unreachable");
+    }
+}
+
+void deleteFrame(DeadFrame const & frame) {
+    for (auto const & object : frame.objects)
+        deleteNow(object);
+    glDeleteSync(frame.fence);
+}
+
+} // namespace
+
+BufferPool & bufferPool() {
+    static BufferPool & pool = *new BufferPool;
+    return pool;
+}
+
+TexturePool & texturePool() {
+    static TexturePool & pool = *new TexturePool;
+    return pool;
+}
+
+void deleteDeferred(GlObjectType type, unsigned int id) {
+    // A value of 0 would be silently ignored anyway.
+    if (id)
+        deletionQueue().current.push_back({ type, id });
+}
+
+void collectDeletedObjects() {
+    auto & queue = deletionQueue();
+    if (!queue.current.empty()) {
+        queue.pending.push_back({ std::move(queue.current), glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+        queue.current.clear();
+    }
+
+    while (!queue.pending.empty()) {
+        GLenum status = glClientWaitSync(queue.pending.front().fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        deleteFrame(queue.pending.front());
+        queue.pending.pop_front();
+    }
+}
+
+void flushDeletedObjects() {
+    auto & queue = deletionQueue();
+    for (auto const & frame : queue.pending)
+        deleteFrame(frame);
+    queue.pending.clear();
+
+    for (auto const & object : queue.current)
+        deleteNow(object);
+    queue.current.clear();
+}
+
+} // namespace core::internal
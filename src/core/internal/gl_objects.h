@@ -0,0 +1,84 @@
+#pragma once
+
+#include "handle_pool.h"
+
+#include <cstddef>
+#include <utility>
+
+namespace core::internal {
+
+enum class GlObjectType { Buffer, Texture, VertexArray };
+
+struct BufferInfo {
+    static constexpr GlObjectType TYPE = GlObjectType::Buffer;
+    size_t bytes = 0;
+};
+
+struct TextureInfo {
+    static constexpr GlObjectType TYPE = GlObjectType::Texture;
+    size_t width = 0;
+    size_t height = 0;
+    size_t layers = 1;
+    // Sized GL internal format.
+    unsigned int format = 0;
+};
+
+// GL objects are deleted only after the GPU has finished the frames
+// submitted before they died, so deleting never waits for in-flight work.
+void deleteDeferred(GlObjectType type, unsigned int id);
+// Fences the objects which died during the frame and deletes the ones whose fence has passed.
+void collectDeletedObjects();
+// Deletes everything queued right away, e.g. before the context is destroyed.
+void flushDeletedObjects();
+
+using BufferPool = HandlePool<BufferInfo>;
+using TexturePool = HandlePool<TextureInfo>;
+
+BufferPool & bufferPool();
+TexturePool & texturePool();
+
+// Owns one GL object through its handle: the object is deleted (deferred) when
+// the entry dies or is assigned over. The `id` of a `Resource` holding an entry
+// is only a copy of its name, kept for GL calls.
+template<class Meta>
+class PoolEntry {
+public:
+    using Handle = typename HandlePool<Meta>::Handle;
+
+    PoolEntry() = default;
+    PoolEntry(HandlePool<Meta> & pool, unsigned int id, Meta meta)
+        : pool(&pool)
+        , entry(pool.create(id, std::move(meta)))
+    {}
+
+    ~PoolEntry() {
+        if (entry) {
+            deleteDeferred(Meta::TYPE, pool->id(entry));
+            pool->destroy(entry);
+        }
+    }
+
+    PoolEntry(PoolEntry const &) = delete;
+    PoolEntry & operator=(PoolEntry const &) = delete;
+
+    PoolEntry(PoolEntry && other) noexcept
+        : pool(other.pool)
+        , entry(std::exchange(other.entry, {}))
+    {}
+
+    PoolEntry & operator=(PoolEntry && other) noexcept {
+        std::swap(pool, other.pool);
+        std::swap(entry, other.entry);
+        return *this;
+    }
+
+    Handle handle() const noexcept { return entry; }
+    unsigned int id() const { return entry ? pool->id(entry) : 0; }
+    Meta & meta() { return pool->meta(entry); }
+
+private:
+    HandlePool<Meta> * pool = nullptr;
+    Handle entry;
+};
+
+} // namespace core::internal
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core::internal {
+
+// Hands out 32-bit generational handles for GL objects: the slot index is in
+// the low 24 bits and the generation in the high 8, so a handle to a destroyed
+// object does not resolve to the object that reuses its slot. GL names and
+// metadata are kept densely packed for iteration; destroying moves the last
+// object into the hole.
+template<class Meta>
+class HandlePool {
+public:
+    struct Handle {
+        uint32_t value = 0;
+
+        explicit operator bool() const noexcept { return value != 0; }
+        bool operator==(Handle const &) const = default;
+    };
+
+    static constexpr uint32_t INDEX_BITS = 24;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+    Handle create(unsigned int id, Meta meta) {
+        uint32_t index;
+        if (free_slots.empty()) {
+            assert(slots.size() < INDEX_MASK && "too many objects in the pool");
+            index = static_cast<uint32_t>(slots.size());
+            slots.push_back({});
+        } else {
+            index = free_slots.back();
+            free_slots.pop_back();
+        }
+
+        auto & slot = slots[index];
+        slot.dense = static_cast<uint32_t>(ids.size());
+        ids.push_back(id);
+        metas.push_back(std::move(meta));
+        owners.push_back(index);
+        return { (uint32_t(slot.generation) << INDEX_BITS) | index };
+    }
+
+    void destroy(Handle handle) {
+        assert(alive(handle));
+        uint32_t index = handle.value & INDEX_MASK;
+        auto & slot = slots[index];
+
+        uint32_t last = static_cast<uint32_t>(ids.size() - 1);
+        ids[slot.dense] = ids[last];
+        metas[slot.dense] = std::move(metas[last]);
+        owners[slot.dense] = owners[last];
+        slots[owners[last]].dense = slot.dense;
+        ids.pop_back();
+        metas.pop_back();
+        owners.pop_back();
+
+        // Generation 0 is skipped, so that no live handle is ever 0.
+        slot.generation = static_cast<uint8_t>(slot.generation + 1);
+        if (slot.generation == 0)
+            slot.generation = 1;
+        free_slots.push_back(index);
+    }
+
+    bool alive(Handle handle) const noexcept {
+        uint32_t index = handle.value & INDEX_MASK;
+        return handle && index < slots.size() && slots[index].generation == (handle.value >> INDEX_BITS);
+    }
+
+    unsigned int id(Handle handle) const {
+        assert(alive(handle));
+        return ids[slots[handle.value & INDEX_MASK].dense];
+    }
+
+    Meta & meta(Handle handle) {
+        assert(alive(handle));
+        return metas[slots[handle.value & INDEX_MASK].dense];
+    }
+
+    Meta const & meta(Handle handle) const {
+        assert(alive(handle));
+        return metas[slots[handle.value & INDEX_MASK].dense];
+    }
+
+    size_t size() const noexcept { return ids.size(); }
+    std::span<unsigned int const> names() const noexcept { return ids; }
+    std::span<Meta const> metadata() const noexcept { return metas; }
+
+private:
+    struct Slot {
+        uint32_t dense = 0;
+        uint8_t generation = 1;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+
+    std::vector<unsigned int> ids;
+    std::vector<Meta> metas;
+    std::vector<uint32_t> owners;
+};
+
+} // namespace core::internal
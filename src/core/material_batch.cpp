@@ -0,0 +1,104 @@
+#include "material_batch.h"
+#include "opengl.h"
+#include "exception.h"
+
+namespace core {
+
+namespace {
+
+constexpr auto MATERIAL_FUNCTIONS =
+    R"~(
+    uniform float uMaterialShininess[MAX_MATERIALS];
+
+    vec3 materialDiffuse(int material, vec2 uv) { return vec3(MATERIAL_SAMPLE(uMaterialDiffuse, material, uv)); }
+    vec3 materialSpecular(int material, vec2 uv) { return vec3(MATERIAL_SAMPLE(uMaterialSpecular, material, uv)); }
+    float materialShininess(int material) { return uMaterialShininess[material]; }
+    )~";
+
+constexpr auto TEXTURE_ARRAY_HEADER =
+    R"~(#version 330 core
+    uniform sampler2DArray uMaterialDiffuse;
+    uniform sampler2DArray uMaterialSpecular;
+    #define MATERIAL_SAMPLE(textures, material, uv) texture(textures, vec3(uv, float(material)))
+    )~";
+
+// ARB_bindless_texture leaves indexing with a value that is not dynamically
+// uniform undefined, NV_gpu_shader5 defines it.
+constexpr auto BINDLESS_HEADER =
+    R"~(#version 400 core
+    #extension GL_ARB_bindless_texture : require
+    #extension GL_NV_gpu_shader5 : require
+    layout(bindless_sampler) uniform sampler2D uMaterialDiffuse[MAX_MATERIALS];
+    layout(bindless_sampler) uniform sampler2D uMaterialSpecular[MAX_MATERIALS];
+    #define MATERIAL_SAMPLE(textures, material, uv) texture(textures[material], uv)
+    )~";
+
+// Specular maps are grey, one channel keeps a quarter of the memory.
+std::vector<Image> specularImages(std::span<MaterialImages const> materials) {
+    std::vector<Image> images;
+    images.reserve(materials.size());
+    for (auto const & material : materials)
+        images.push_back(converted(*material.specular, Image::Format::R8));
+    return images;
+}
+
+} // namespace
+
+MaterialBatch::Mode MaterialBatch::preferredMode() {
+    return GLEW_ARB_bindless_texture && GLEW_NV_gpu_shader5 ? Mode::Bindless : Mode::TextureArray;
+}
+
+std::string MaterialBatch::shaderHeader(Mode mode) {
+    using namespace std::string_literals;
+    std::string header = mode == Mode::Bindless ? BINDLESS_HEADER : TEXTURE_ARRAY_HEADER;
+    // #version has to stay on the first line.
+    auto version_end = header.find('\n') + 1;
+    header.insert(version_end, "#define MAX_MATERIALS " + std::to_string(MAX_MATERIALS) + "\n");
+    return header + MATERIAL_FUNCTIONS;
+}
+
+MaterialBatch::MaterialBatch(std::span<MaterialImages const> materials, Mode mode, Texture2D::Config config)
+    : batch_mode(mode)
+{
+    REQUIRE(!materials.empty(), "Material batch should contain at least one material");
+    REQUIRE(materials.size() <= MAX_MATERIALS, "Too many materials in one batch");
+    REQUIRE(mode != Mode::Bindless || (GLEW_ARB_bindless_texture && GLEW_NV_gpu_shader5), "Bindless materials are not supported");
+
+    shininess.reserve(materials.size());
+    for (auto const & material : materials)
+        shininess.push_back(material.shininess);
+
+    auto specular = specularImages(materials);
+    if (mode == Mode::TextureArray) {
+        std::vector<Image const *> diffuse_layers;
+        std::vector<Image const *> specular_layers;
+        for (size_t i = 0; i < materials.size(); ++i) {
+            diffuse_layers.push_back(materials[i].diffuse.get());
+            specular_layers.push_back(&specular[i]);
+        }
+        diffuse_array.emplace(diffuse_layers, config);
+        specular_array.emplace(specular_layers, config);
+        return;
+    }
+
+    auto makeResident = [&](Image const & image) {
+        auto const & texture = textures.emplace_back(std::make_unique<Texture2D>(image, config));
+        auto handle = texture->bindlessHandle();
+        glMakeTextureHandleResidentARB(handle);
+        return handle;
+    };
+
+    for (size_t i = 0; i < materials.size(); ++i) {
+        diffuse_handles.push_back(makeResident(*materials[i].diffuse));
+        specular_handles.push_back(makeResident(specular[i]));
+    }
+}
+
+MaterialBatch::~MaterialBatch() {
+    for (auto handle : diffuse_handles)
+        glMakeTextureHandleNonResidentARB(handle);
+    for (auto handle : specular_handles)
+        glMakeTextureHandleNonResidentARB(handle);
+}
+
+} // namespace core
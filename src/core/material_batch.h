@@ -0,0 +1,65 @@
+#pragma once
+
+#include "image.h"
+#include "texture.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace core {
+
+struct MaterialImages {
+    SharedImage diffuse;
+    SharedImage specular;
+    float shininess;
+};
+
+// Textures of several materials gathered so that objects with different
+// materials can share a single (instanced) draw call: shaders pick the
+// material by index instead of rebinding texture units between draws.
+//
+// `TextureArray` stores every material as a layer of two GL_TEXTURE_2D_ARRAYs,
+// `Bindless` keeps ordinary textures and passes ARB_bindless_texture handles.
+class MaterialBatch {
+public:
+    enum class Mode { TextureArray, Bindless };
+
+    static constexpr size_t MAX_MATERIALS = 16;
+
+    // Bindless when ARB_bindless_texture and NV_gpu_shader5 are available, texture arrays otherwise.
+    static Mode preferredMode();
+
+    // GLSL preamble (including #version) that declares `materialDiffuse(int, vec2)`,
+    // `materialSpecular(int, vec2)` and `materialShininess(int)`.
+    static std::string shaderHeader(Mode mode);
+
+    MaterialBatch(std::span<MaterialImages const> materials, Mode mode = preferredMode(), Texture2D::Config config = {});
+    ~MaterialBatch();
+
+    MaterialBatch(MaterialBatch const &) = delete;
+    MaterialBatch & operator=(MaterialBatch const &) = delete;
+
+    Mode mode() const noexcept { return batch_mode; }
+    size_t size() const noexcept { return shininess.size(); }
+
+private:
+    friend struct UniformMaterialBatch;
+
+    Mode batch_mode;
+    std::vector<float> shininess;
+
+    // Mode::TextureArray
+    std::optional<Texture2DArray> diffuse_array;
+    std::optional<Texture2DArray> specular_array;
+
+    // Mode::Bindless
+    std::vector<std::unique_ptr<Texture2D>> textures;
+    std::vector<uint64_t> diffuse_handles;
+    std::vector<uint64_t> specular_handles;
+};
+
+} // namespace core
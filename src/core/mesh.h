@@ -0,0 +1,59 @@
+#pragma once
+
+#include "indexer.h"
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+namespace core {
+
+template<class Vertex, size_t vertex_count, size_t index_count>
+struct IndexedMesh {
+    using VertexType = Vertex;
+    using IndexType = IndexFor<vertex_count>;
+
+    std::array<Vertex, vertex_count> vertices;
+    std::array<IndexType, index_count> indices;
+};
+
+namespace internal {
+
+template<class Vertex, size_t N>
+consteval size_t countUniqueVertices(std::array<Vertex, N> const & vertices) {
+    size_t unique = 0;
+    for (size_t i = 0; i < N; ++i) {
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; ++j)
+            seen = vertices[j] == vertices[i];
+        unique += !seen;
+    }
+    return unique;
+}
+
+} // namespace internal
+
+// Merges equal vertices of an unindexed triangle list at compile time.
+// Vertices keep the order of their first occurrence, so the resulting
+// index list walks the source triangles exactly as they were written.
+template<auto const & source>
+consteval auto weld() {
+    using Source = std::remove_cvref_t<decltype(source)>;
+    using Vertex = typename Source::value_type;
+    constexpr size_t index_count = std::tuple_size_v<Source>;
+    constexpr size_t vertex_count = internal::countUniqueVertices(source);
+
+    IndexedMesh<Vertex, vertex_count, index_count> mesh{};
+    size_t welded = 0;
+    for (size_t i = 0; i < index_count; ++i) {
+        size_t j = 0;
+        while (j < welded && !(mesh.vertices[j] == source[i]))
+            ++j;
+        if (j == welded)
+            mesh.vertices[welded++] = source[i];
+        mesh.indices[i] = static_cast<typename decltype(mesh)::IndexType>(j);
+    }
+    return mesh;
+}
+
+} // namespace core
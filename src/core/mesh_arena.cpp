@@ -0,0 +1,217 @@
+#include "mesh_arena.h"
+#include "exception.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace core {
+
+namespace {
+
+unsigned int orderOf(size_t size) {
+    return static_cast<unsigned int>(std::bit_width(std::bit_ceil(std::max<size_t>(size, 1))) - 1);
+}
+
+IndexBuffer emptyIndexBuffer(IndexType type, size_t count, BufferUsage usage) {
+    if (type == IndexType::UnsignedShort)
+        return IndexBuffer(static_cast<uint16_t const *>(nullptr), count, usage);
+    return IndexBuffer(static_cast<uint32_t const *>(nullptr), count, usage);
+}
+
+} // namespace
+
+BuddyAllocator::BuddyAllocator(size_t capacity)
+    : max_order(orderOf(capacity))
+    , free_blocks(max_order + 1)
+{
+    free_blocks[max_order].insert(0);
+}
+
+std::optional<size_t> BuddyAllocator::allocate(size_t size) {
+    unsigned int order = orderOf(size);
+    if (order > max_order)
+        return std::nullopt;
+
+    unsigned int available = order;
+    while (available <= max_order && free_blocks[available].empty())
+        ++available;
+    if (available > max_order)
+        return std::nullopt;
+
+    size_t offset = *free_blocks[available].begin();
+    free_blocks[available].erase(free_blocks[available].begin());
+
+    // Split until the block fits, the upper halves become free buddies.
+    while (available > order) {
+        --available;
+        free_blocks[available].insert(offset + (size_t(1) << available));
+    }
+
+    allocated.emplace(offset, order);
+    used_units += size_t(1) << order;
+    return offset;
+}
+
+void BuddyAllocator::free(size_t offset) {
+    auto it = allocated.find(offset);
+    assert(it != allocated.end() && "freeing a block which was not allocated");
+    unsigned int order = it->second;
+    allocated.erase(it);
+    used_units -= size_t(1) << order;
+
+    while (order < max_order) {
+        size_t buddy = offset ^ (size_t(1) << order);
+        auto & blocks = free_blocks[order];
+        auto buddy_it = blocks.find(buddy);
+        if (buddy_it == blocks.end())
+            break;
+        blocks.erase(buddy_it);
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+    free_blocks[order].insert(offset);
+}
+
+MeshArena::Page::Page(size_t vertex_size, size_t vertex_count, size_t index_count, IndexType index_type)
+    : vertex_space(vertex_count)
+    , index_space(index_count)
+    , vbo(static_cast<std::byte const *>(nullptr), vertex_space.capacity(), vertex_size, BufferUsage::StaticDraw)
+    , ibo(emptyIndexBuffer(index_type, index_space.capacity(), BufferUsage::StaticDraw))
+{}
+
+MeshArena::MeshArena(size_t vertex_size, size_t vertices_per_page, size_t indices_per_page, IndexType index_type)
+    : vertex_size(vertex_size)
+    , vertices_per_page(vertices_per_page)
+    , indices_per_page(indices_per_page)
+    , index_type(index_type)
+{
+    REQUIRE(vertex_size > 0 && vertices_per_page > 0 && indices_per_page > 0, "Mesh arena pages cannot be empty");
+}
+
+void MeshArena::checkVertexSize(size_t size) const {
+    REQUIRE(size == vertex_size, "All meshes of an arena should have the same vertex format");
+}
+
+std::optional<MeshRange> MeshArena::place(Page & page, size_t page_number, size_t vertex_count, size_t index_count) {
+    auto base_vertex = page.vertex_space.allocate(vertex_count);
+    if (!base_vertex)
+        return std::nullopt;
+    auto first_index = page.index_space.allocate(index_count);
+    if (!first_index) {
+        page.vertex_space.free(*base_vertex);
+        return std::nullopt;
+    }
+    return MeshRange {
+        .page = page_number,
+        .first_index = *first_index,
+        .index_count = index_count,
+        .base_vertex = *base_vertex,
+        .vertex_count = vertex_count,
+    };
+}
+
+MeshArena::Handle MeshArena::add(std::byte const * vertices, size_t vertex_count, std::span<std::byte const> indices) {
+    size_t index_count = indices.size() / sizeOf(index_type);
+    REQUIRE(vertex_count <= vertices_per_page && index_count <= indices_per_page, "Mesh does not fit into a mesh arena page");
+    REQUIRE(index_type == IndexType::UnsignedInt || vertex_count <= (size_t(1) << 16), "Mesh has too many vertices for 16-bit indices");
+
+    std::optional<MeshRange> range;
+    for (size_t i = 0; i < page_list.size() && !range; ++i)
+        range = place(*page_list[i], i, vertex_count, index_count);
+    if (!range) {
+        page_list.push_back(std::make_unique<Page>(vertex_size, vertices_per_page, indices_per_page, index_type));
+        range = place(*page_list.back(), page_list.size() - 1, vertex_count, index_count);
+    }
+    assert(range);
+
+    auto & page = *page_list[range->page];
+    page.vbo.update(range->base_vertex, std::span<std::byte const>(vertices, vertex_count * vertex_size));
+    page.ibo.update(range->first_index, indices);
+
+    Handle handle;
+    if (free_handles.empty()) {
+        handle = ranges.size();
+        ranges.emplace_back(range);
+    } else {
+        handle = free_handles.back();
+        free_handles.pop_back();
+        ranges[handle] = range;
+    }
+    return handle;
+}
+
+void MeshArena::remove(Handle handle) {
+    auto & range = ranges.at(handle);
+    REQUIRE(range, "Mesh was already removed from the arena");
+
+    auto & page = *page_list[range->page];
+    page.vertex_space.free(range->base_vertex);
+    page.index_space.free(range->first_index);
+    range.reset();
+    free_handles.push_back(handle);
+}
+
+void MeshArena::defragment() {
+    for (size_t page_number = 0; page_number < page_list.size(); ++page_number) {
+        auto & page = *page_list[page_number];
+
+        std::vector<MeshRange *> meshes;
+        for (auto & range : ranges) {
+            if (range && range->page == page_number)
+                meshes.push_back(&*range);
+        }
+        if (meshes.empty())
+            continue;
+
+        std::vector<MeshRange> moved;
+        moved.reserve(meshes.size());
+        for (auto const * range : meshes)
+            moved.push_back(*range);
+
+        std::vector<size_t> order(meshes.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+
+        // Buddy blocks allocated largest first end up packed without holes.
+        BuddyAllocator vertex_space(page.vertex_space.capacity());
+        std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+            return page.vertex_space.sizeOf(meshes[lhs]->base_vertex) > page.vertex_space.sizeOf(meshes[rhs]->base_vertex);
+        });
+        for (auto i : order)
+            moved[i].base_vertex = *vertex_space.allocate(moved[i].vertex_count);
+
+        BuddyAllocator index_space(page.index_space.capacity());
+        std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+            return page.index_space.sizeOf(meshes[lhs]->first_index) > page.index_space.sizeOf(meshes[rhs]->first_index);
+        });
+        for (auto i : order)
+            moved[i].first_index = *index_space.allocate(moved[i].index_count);
+
+        bool changed = false;
+        for (size_t i = 0; i < meshes.size(); ++i)
+            changed |= moved[i].base_vertex != meshes[i]->base_vertex || moved[i].first_index != meshes[i]->first_index;
+        if (!changed)
+            continue;
+
+        // Ranges may overlap their old places, so the page goes through a staging copy.
+        VertexBuffer vertex_staging(static_cast<std::byte const *>(nullptr), page.vertex_space.capacity(), vertex_size, BufferUsage::StreamDraw);
+        auto index_staging = emptyIndexBuffer(index_type, page.index_space.capacity(), BufferUsage::StreamDraw);
+        size_t index_size = sizeOf(index_type);
+        page.vbo.copyTo(vertex_staging, 0, 0, page.vertex_space.capacity() * vertex_size);
+        page.ibo.copyTo(index_staging, 0, 0, page.index_space.capacity() * index_size);
+
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            vertex_staging.copyTo(page.vbo,
+                meshes[i]->base_vertex * vertex_size, moved[i].base_vertex * vertex_size, moved[i].vertex_count * vertex_size);
+            index_staging.copyTo(page.ibo,
+                meshes[i]->first_index * index_size, moved[i].first_index * index_size, moved[i].index_count * index_size);
+            *meshes[i] = moved[i];
+        }
+
+        page.vertex_space = std::move(vertex_space);
+        page.index_space = std::move(index_space);
+    }
+}
+
+} // namespace core
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "vertex_buffer.h"
+#include "index_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <set>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace core {
+
+// Binary buddy allocator over `capacity` abstract units (vertices, indices, bytes).
+class BuddyAllocator {
+public:
+    // `capacity` is rounded up to a power of two.
+    explicit BuddyAllocator(size_t capacity);
+
+    std::optional<size_t> allocate(size_t size);
+    void free(size_t offset);
+
+    size_t capacity() const noexcept { return size_t(1) << max_order; }
+    size_t used() const noexcept { return used_units; }
+    size_t sizeOf(size_t offset) const { return size_t(1) << allocated.at(offset); }
+
+private:
+    unsigned int max_order;
+    size_t used_units = 0;
+    std::vector<std::set<size_t>> free_blocks;
+    std::unordered_map<size_t, unsigned int> allocated;
+};
+
+// Where a mesh lives inside a `MeshArena`, everything a base vertex draw needs.
+struct MeshRange {
+    size_t page;
+    size_t first_index;
+    size_t index_count;
+    size_t base_vertex;
+    size_t vertex_count;
+};
+
+// Packs many small meshes of the same vertex format into a few large
+// vertex/index buffer pairs, so that switching meshes does not switch buffers.
+// Indices stay relative to their mesh and are drawn with a base vertex, so
+// 16-bit indices address any mesh of up to 65536 vertices wherever it lands.
+class MeshArena {
+public:
+    using Handle = size_t;
+
+    MeshArena(size_t vertex_size, size_t vertices_per_page = 1 << 16, size_t indices_per_page = 1 << 18,
+        IndexType index_type = IndexType::UnsignedShort);
+
+    // Indices are converted to the index type of the arena.
+    template<class Vertex, class Index>
+    Handle add(std::span<Vertex const> vertices, std::span<Index const> indices) {
+        checkVertexSize(sizeof(Vertex));
+        auto const * vertex_bytes = reinterpret_cast<std::byte const *>(vertices.data());
+        if (indexTypeOf<Index>() == index_type)
+            return add(vertex_bytes, vertices.size(), std::as_bytes(indices));
+        if (index_type == IndexType::UnsignedShort) {
+            std::vector<uint16_t> narrow(indices.begin(), indices.end());
+            return add(vertex_bytes, vertices.size(), std::as_bytes(std::span<uint16_t const>(narrow)));
+        }
+        std::vector<uint32_t> wide(indices.begin(), indices.end());
+        return add(vertex_bytes, vertices.size(), std::as_bytes(std::span<uint32_t const>(wide)));
+    }
+
+    void remove(Handle handle);
+
+    MeshRange const & range(Handle handle) const { return *ranges.at(handle); }
+
+    size_t pages() const noexcept { return page_list.size(); }
+    VertexBuffer const & vertices(size_t page) const { return page_list[page]->vbo; }
+    IndexBuffer const & indices(size_t page) const { return page_list[page]->ibo; }
+    IndexType indexType() const noexcept { return index_type; }
+
+    // Moves the meshes of every page to its beginning, closing the gaps left by removed ones.
+    // Ranges change but handles and buffers stay valid.
+    void defragment();
+
+private:
+    struct Page {
+        Page(size_t vertex_size, size_t vertex_count, size_t index_count, IndexType index_type);
+
+        BuddyAllocator vertex_space;
+        BuddyAllocator index_space;
+        VertexBuffer vbo;
+        IndexBuffer ibo;
+    };
+
+    void checkVertexSize(size_t size) const;
+    Handle add(std::byte const * vertices, size_t vertex_count, std::span<std::byte const> indices);
+    std::optional<MeshRange> place(Page & page, size_t page_number, size_t vertex_count, size_t index_count);
+
+    size_t vertex_size;
+    size_t vertices_per_page;
+    size_t indices_per_page;
+    IndexType index_type;
+    // Drawers keep references to the buffers, so pages must not move.
+    std::vector<std::unique_ptr<Page>> page_list;
+    std::vector<std::optional<MeshRange>> ranges;
+    std::vector<Handle> free_handles;
+};
+
+} // namespace core
@@ -0,0 +1,372 @@
+#include "mesh_optimizer.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+
+namespace core {
+
+namespace {
+
+constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+// Triangles adjacent to every vertex, stored as one array with per-vertex offsets.
+struct Adjacency {
+    std::vector<size_t> offsets;
+    std::vector<size_t> triangles;
+
+    std::span<size_t const> of(size_t vertex) const {
+        return std::span<size_t const>(triangles).subspan(offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+    }
+};
+
+template<class Index>
+Adjacency buildAdjacency(std::span<Index const> indices, size_t vertex_count) {
+    Adjacency adjacency {
+        .offsets = std::vector<size_t>(vertex_count + 1, 0),
+        .triangles = std::vector<size_t>(indices.size()),
+    };
+
+    for (auto index : indices)
+        ++adjacency.offsets[size_t(index) + 1];
+    for (size_t v = 0; v < vertex_count; ++v)
+        adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+    std::vector<size_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i)
+        adjacency.triangles[cursor[indices[i]]++] = i / 3;
+
+    return adjacency;
+}
+
+glm::vec3 positionOf(std::byte const * vertices, size_t stride, size_t vertex) {
+    glm::vec3 position;
+    std::memcpy(&position, vertices + vertex * stride, sizeof(position));
+    return position;
+}
+
+struct Cluster {
+    size_t begin;
+    size_t end;
+    float sort_key = 0;
+};
+
+// FIFO cache emulation: a vertex is cached while fewer than `cache_size` misses happened after its own one.
+struct CacheSimulator {
+    explicit CacheSimulator(size_t vertex_count, size_t cache_size)
+        : timestamps(vertex_count, 0)
+        , cache_size(cache_size)
+        , time(cache_size + 1)
+    {}
+
+    bool access(size_t vertex) {
+        if (time - timestamps[vertex] <= cache_size)
+            return false;
+        timestamps[vertex] = time++;
+        return true;
+    }
+
+    void flush() { time += cache_size + 1; }
+
+    std::vector<size_t> timestamps;
+    size_t cache_size;
+    size_t time;
+};
+
+} // namespace
+
+std::ostream & operator<<(std::ostream & out, MeshOptimizationReport const & report) {
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(3)
+        << "ACMR " << report.before.acmr << " -> " << report.after.acmr
+        << ", ATVR " << report.before.atvr << " -> " << report.after.atvr
+        << ", vertices " << report.vertex_count_before << " -> " << report.vertex_count_after;
+    out.flags(flags);
+    out.precision(precision);
+    return out;
+}
+
+template<class Index>
+VertexCacheStats analyzeVertexCache(std::span<Index const> indices, size_t vertex_count, size_t cache_size) {
+    assert(indices.size() % 3 == 0);
+    if (indices.empty())
+        return {};
+
+    CacheSimulator cache(vertex_count, cache_size);
+    std::vector<bool> referenced(vertex_count, false);
+    size_t misses = 0;
+    size_t unique = 0;
+
+    for (auto index : indices) {
+        assert(size_t(index) < vertex_count);
+        misses += cache.access(index);
+        if (!referenced[index]) {
+            referenced[index] = true;
+            ++unique;
+        }
+    }
+
+    return {
+        .acmr = float(misses) / float(indices.size() / 3),
+        .atvr = float(misses) / float(unique),
+    };
+}
+
+template<class Index>
+std::vector<size_t> optimizeVertexCache(std::span<Index> indices, size_t vertex_count, size_t cache_size) {
+    assert(indices.size() % 3 == 0);
+    std::vector<size_t> clusters;
+    if (indices.empty())
+        return clusters;
+
+    std::vector<Index> source(indices.begin(), indices.end());
+    auto adjacency = buildAdjacency(std::span<Index const>(source), vertex_count);
+
+    std::vector<size_t> live(vertex_count);
+    for (size_t v = 0; v < vertex_count; ++v)
+        live[v] = adjacency.of(v).size();
+
+    CacheSimulator cache(vertex_count, cache_size);
+    std::vector<bool> emitted(source.size() / 3, false);
+    std::vector<size_t> dead_end;
+    std::vector<size_t> candidates;
+    dead_end.reserve(source.size());
+
+    size_t cursor = 0;
+    size_t emitted_count = 0;
+
+    auto skipDeadEnd = [&] {
+        while (!dead_end.empty()) {
+            size_t v = dead_end.back();
+            dead_end.pop_back();
+            if (live[v] > 0)
+                return v;
+        }
+        for (; cursor < vertex_count; ++cursor) {
+            if (live[cursor] > 0)
+                return cursor;
+        }
+        return NONE;
+    };
+
+    auto nextVertex = [&] {
+        size_t best = NONE;
+        size_t best_priority = 0;
+        for (auto v : candidates) {
+            if (live[v] == 0)
+                continue;
+            // Prefer vertices which will still be in the cache after their remaining triangles are emitted.
+            size_t age = cache.time - cache.timestamps[v];
+            size_t priority = age + 2 * live[v] <= cache_size ? age : 0;
+            if (best == NONE || priority > best_priority) {
+                best = v;
+                best_priority = priority;
+            }
+        }
+        return best;
+    };
+
+    size_t current = skipDeadEnd();
+    bool hard_boundary = true;
+    while (current != NONE) {
+        if (hard_boundary)
+            clusters.push_back(emitted_count);
+
+        candidates.clear();
+        for (auto triangle : adjacency.of(current)) {
+            if (emitted[triangle])
+                continue;
+            for (size_t corner = 0; corner < 3; ++corner) {
+                auto index = source[triangle * 3 + corner];
+                indices[emitted_count * 3 + corner] = index;
+                dead_end.push_back(index);
+                candidates.push_back(index);
+                --live[index];
+                cache.access(index);
+            }
+            emitted[triangle] = true;
+            ++emitted_count;
+        }
+
+        current = nextVertex();
+        hard_boundary = current == NONE;
+        if (hard_boundary)
+            current = skipDeadEnd();
+    }
+
+    assert(emitted_count * 3 == indices.size());
+    return clusters;
+}
+
+template<class Index>
+void optimizeOverdraw(
+    std::span<Index> indices,
+    std::span<size_t const> hard_clusters,
+    std::byte const * vertices, size_t vertex_count, size_t stride,
+    float threshold,
+    size_t cache_size)
+{
+    assert(indices.size() % 3 == 0);
+    size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0 || hard_clusters.empty())
+        return;
+
+    float max_acmr = analyzeVertexCache(std::span<Index const>(indices), vertex_count, cache_size).acmr * threshold;
+
+    // Split hard clusters at every point where the cache has warmed up enough
+    // that starting cold again costs no more than `threshold` of the original ACMR.
+    std::vector<Cluster> clusters;
+    CacheSimulator cache(vertex_count, cache_size);
+    for (size_t i = 0; i < hard_clusters.size(); ++i) {
+        size_t end = i + 1 < hard_clusters.size() ? hard_clusters[i + 1] : triangle_count;
+        size_t begin = hard_clusters[i];
+        size_t misses = 0;
+        cache.flush();
+        for (size_t triangle = begin; triangle < end; ++triangle) {
+            for (size_t corner = 0; corner < 3; ++corner)
+                misses += cache.access(indices[triangle * 3 + corner]);
+
+            if (triangle + 1 < end && float(misses) <= max_acmr * float(triangle + 1 - begin)) {
+                clusters.push_back({.begin = begin, .end = triangle + 1});
+                begin = triangle + 1;
+                misses = 0;
+                cache.flush();
+            }
+        }
+        clusters.push_back({.begin = begin, .end = end});
+    }
+
+    auto triangleAt = [&](size_t triangle, glm::vec3 & centroid, glm::vec3 & normal) {
+        auto a = positionOf(vertices, stride, indices[triangle * 3 + 0]);
+        auto b = positionOf(vertices, stride, indices[triangle * 3 + 1]);
+        auto c = positionOf(vertices, stride, indices[triangle * 3 + 2]);
+        normal = glm::cross(b - a, c - a);
+        centroid = (a + b + c) / 3.0f;
+    };
+
+    // Area weighted centroid of the mesh.
+    glm::vec3 mesh_centroid(0.0f);
+    float mesh_area = 0;
+    for (size_t triangle = 0; triangle < triangle_count; ++triangle) {
+        glm::vec3 centroid, normal;
+        triangleAt(triangle, centroid, normal);
+        float area = glm::length(normal);
+        mesh_centroid += centroid * area;
+        mesh_area += area;
+    }
+    if (mesh_area > 0)
+        mesh_centroid = mesh_centroid / mesh_area;
+
+    // Clusters facing away from the center are likely to occlude the others.
+    for (auto & cluster : clusters) {
+        glm::vec3 cluster_centroid(0.0f);
+        glm::vec3 cluster_normal(0.0f);
+        float cluster_area = 0;
+        for (size_t triangle = cluster.begin; triangle < cluster.end; ++triangle) {
+            glm::vec3 centroid, normal;
+            triangleAt(triangle, centroid, normal);
+            float area = glm::length(normal);
+            cluster_centroid += centroid * area;
+            cluster_normal += normal;
+            cluster_area += area;
+        }
+        float normal_length = glm::length(cluster_normal);
+        if (cluster_area > 0 && normal_length > 0)
+            cluster.sort_key = glm::dot(cluster_centroid / cluster_area - mesh_centroid, cluster_normal / normal_length);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](auto const & lhs, auto const & rhs) {
+        return lhs.sort_key > rhs.sort_key;
+    });
+
+    std::vector<Index> source(indices.begin(), indices.end());
+    size_t offset = 0;
+    for (auto const & cluster : clusters) {
+        auto from = source.begin() + static_cast<ptrdiff_t>(cluster.begin * 3);
+        auto to = source.begin() + static_cast<ptrdiff_t>(cluster.end * 3);
+        std::copy(from, to, indices.begin() + static_cast<ptrdiff_t>(offset));
+        offset += cluster.end * 3 - cluster.begin * 3;
+    }
+}
+
+template<class Index>
+size_t optimizeVertexFetch(std::span<Index> indices, std::byte * vertices, size_t vertex_count, size_t stride) {
+    std::vector<size_t> remap(vertex_count, NONE);
+    size_t next = 0;
+    for (auto & index : indices) {
+        assert(size_t(index) < vertex_count);
+        if (remap[index] == NONE)
+            remap[index] = next++;
+        index = static_cast<Index>(remap[index]);
+    }
+
+    // Unreferenced vertices follow in their original order.
+    size_t referenced = next;
+    for (auto & target : remap) {
+        if (target == NONE)
+            target = next++;
+    }
+
+    std::vector<std::byte> source(vertices, vertices + vertex_count * stride);
+    for (size_t v = 0; v < vertex_count; ++v)
+        std::memcpy(vertices + remap[v] * stride, source.data() + v * stride, stride);
+    return referenced;
+}
+
+template VertexCacheStats analyzeVertexCache<uint16_t>(std::span<uint16_t const>, size_t, size_t);
+template std::vector<size_t> optimizeVertexCache<uint16_t>(std::span<uint16_t>, size_t, size_t);
+template void optimizeOverdraw<uint16_t>(std::span<uint16_t>, std::span<size_t const>, std::byte const *, size_t, size_t, float, size_t);
+template size_t optimizeVertexFetch<uint16_t>(std::span<uint16_t>, std::byte *, size_t, size_t);
+
+template VertexCacheStats analyzeVertexCache<uint32_t>(std::span<uint32_t const>, size_t, size_t);
+template std::vector<size_t> optimizeVertexCache<uint32_t>(std::span<uint32_t>, size_t, size_t);
+template void optimizeOverdraw<uint32_t>(std::span<uint32_t>, std::span<size_t const>, std::byte const *, size_t, size_t, float, size_t);
+template size_t optimizeVertexFetch<uint32_t>(std::span<uint32_t>, std::byte *, size_t, size_t);
+
+namespace mesh_optimization {
+
+namespace {
+
+struct Entry {
+    std::string name;
+    MeshOptimizationReport report;
+};
+
+// Never destroyed: static renderers may optimise meshes until the very end.
+std::vector<Entry> & entries() {
+    static std::vector<Entry> & instance = *new std::vector<Entry>;
+    return instance;
+}
+
+} // namespace
+
+void record(std::string_view name, MeshOptimizationReport const & report) {
+    auto & all = entries();
+    auto it = std::find_if(all.begin(), all.end(), [&](Entry const & entry) { return entry.name == name; });
+    if (it == all.end()) {
+        all.push_back({ std::string(name), report });
+    } else {
+        it->report = report;
+    }
+}
+
+std::ostream & report(std::ostream & out) {
+    if (entries().empty())
+        return out;
+    out << "Optimised meshes:\n";
+    for (auto const & entry : entries())
+        out << "  " << entry.name << ": " << entry.report << '\n';
+    return out;
+}
+
+} // namespace mesh_optimization
+
+} // namespace core
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace core {
+
+constexpr size_t DEFAULT_VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats {
+    // Average cache miss ratio: transformed vertices per triangle (0.5 at best, 3 at worst).
+    float acmr = 0;
+    // Average transformed vertex ratio: transformed vertices per unique vertex (1 at best).
+    float atvr = 0;
+};
+
+struct MeshOptimizationReport {
+    VertexCacheStats before;
+    VertexCacheStats after;
+    size_t vertex_count_before = 0;
+    size_t vertex_count_after = 0;
+};
+
+std::ostream & operator<<(std::ostream & out, MeshOptimizationReport const & report);
+
+namespace mesh_optimization {
+
+// Keeps the last report of the mesh called `name` for `report`.
+void record(std::string_view name, MeshOptimizationReport const & report);
+
+std::ostream & report(std::ostream & out);
+
+} // namespace mesh_optimization
+
+// Simulates a FIFO post-transform cache of `cache_size` entries over a triangle list.
+template<class Index>
+VertexCacheStats analyzeVertexCache(std::span<Index const> indices, size_t vertex_count, size_t cache_size = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Reorders triangles in place with Tipsify (Sander et al. 2007).
+// Returns the first triangle of every cluster, i.e. every point where the
+// walk had to jump to an unrelated part of the mesh.
+template<class Index>
+std::vector<size_t> optimizeVertexCache(std::span<Index> indices, size_t vertex_count, size_t cache_size = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Reorders the clusters produced by `optimizeVertexCache` front-to-back for a
+// convex-ish mesh, so that outward facing clusters are drawn first and hide
+// the rest. Clusters are split further while the ACMR stays within `threshold`
+// of the original one. Vertex positions are read as glm::vec3 at the start of
+// every vertex.
+template<class Index>
+void optimizeOverdraw(
+    std::span<Index> indices,
+    std::span<size_t const> clusters,
+    std::byte const * vertices, size_t vertex_count, size_t stride,
+    float threshold = 1.05f,
+    size_t cache_size = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Moves vertices into the order of their first use in `indices` and rewrites
+// the indices. Unreferenced vertices are moved behind the referenced ones,
+// whose count is returned.
+template<class Index>
+size_t optimizeVertexFetch(std::span<Index> indices, std::byte * vertices, size_t vertex_count, size_t stride);
+
+// Runs all the passes above on an indexed triangle list before it is uploaded.
+template<class Vertex, class Index>
+MeshOptimizationReport optimizeMesh(std::span<Vertex> vertices, std::span<Index> indices) {
+    static_assert(sizeof(Vertex) >= sizeof(glm::vec3), "Vertices should start with their position");
+    auto * data = reinterpret_cast<std::byte *>(vertices.data());
+    MeshOptimizationReport report;
+    report.before = analyzeVertexCache(std::span<Index const>(indices), vertices.size());
+    report.vertex_count_before = vertices.size();
+
+    auto clusters = optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, std::span<size_t const>(clusters), data, vertices.size(), sizeof(Vertex));
+    report.vertex_count_after = optimizeVertexFetch(indices, data, vertices.size(), sizeof(Vertex));
+    report.after = analyzeVertexCache(std::span<Index const>(indices), report.vertex_count_after);
+    return report;
+}
+
+} // namespace core
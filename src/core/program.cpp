@@ -1,9 +1,11 @@
 #include "program.h"
+#include "texture_streamer.h"
 #include "opengl.h"
 #include "exception.h"
 
 #include <string>
 #include <cassert>
+#include <algorithm>
 
 #include <glm/gtc/type_ptr.hpp>
 
@@ -17,14 +19,36 @@ constexpr int INVALID_LOCATION = -1;
 
 unsigned int sizeOf(Attribute::Type type) {
     switch (type) {
-        case Attribute::Type::Float: return sizeof(float);
+        case Attribute::Type::Float:             return sizeof(GLfloat);
+        case Attribute::Type::HalfFloat:         return sizeof(GLhalf);
+        case Attribute::Type::Byte:              return sizeof(GLbyte);
+        case Attribute::Type::UnsignedByte:      return sizeof(GLubyte);
+        case Attribute::Type::Short:             return sizeof(GLshort);
+        case Attribute::Type::UnsignedShort:     return sizeof(GLushort);
+        case Attribute::Type::Int2_10_10_10_Rev: return sizeof(GLuint);
         default: assert(false && "unreachable");
     }
 }
 
+unsigned int sizeOf(Attribute const & attr) {
+    if (attr.type == Attribute::Type::Int2_10_10_10_Rev)
+        return sizeOf(attr.type);
+    return sizeOf(attr.type) * attr.size;
+}
+
+unsigned int alignUp(unsigned int value, unsigned int alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
 unsigned int toGL(Attribute::Type type) {
     switch (type) {
-        case Attribute::Type::Float: return GL_FLOAT;
+        case Attribute::Type::Float:             return GL_FLOAT;
+        case Attribute::Type::HalfFloat:         return GL_HALF_FLOAT;
+        case Attribute::Type::Byte:              return GL_BYTE;
+        case Attribute::Type::UnsignedByte:      return GL_UNSIGNED_BYTE;
+        case Attribute::Type::Short:             return GL_SHORT;
+        case Attribute::Type::UnsignedShort:     return GL_UNSIGNED_SHORT;
+        case Attribute::Type::Int2_10_10_10_Rev: return GL_INT_2_10_10_10_REV;
         default: assert(false && "unreachable");
     }
 }
@@ -135,6 +159,14 @@ int Program::uniformLocation(char const * name) const {
     return location;
 }
 
+void Program::bindUniformBlock(char const * name, unsigned int binding) const {
+    using namespace std::string_literals;
+
+    GLuint index = glGetUniformBlockIndex(id, name);
+    REQUIRE(index != GL_INVALID_INDEX, "There is no such uniform block: "s + name);
+    glUniformBlockBinding(id, index, binding);
+}
+
 int Program::attributeLocation(char const * name) const {
     using namespace std::string_literals;
 
@@ -146,13 +178,22 @@ int Program::attributeLocation(char const * name) const {
 void Program::loadAttributes(std::vector<Attribute> const & attrs) {
     using namespace std::string_literals;
 
+    auto & [attributes, stride] = layout;
     stride = 0;
     attributes.reserve(attrs.size());
 
+    // Attributes are laid out the way a C++ struct with the same members would be.
+    unsigned int max_alignment = 1;
     for (auto const & attr : attrs) {
+        REQUIRE(attr.type != Attribute::Type::Int2_10_10_10_Rev || attr.size == 4,
+            "Packed attribute should have four components: "s + attr.name);
+        unsigned int alignment = sizeOf(attr.type);
+        max_alignment = std::max(max_alignment, alignment);
+        stride = alignUp(stride, alignment);
         attributes.emplace_back(attributeLocation(attr.name), stride, attr);
-        stride += sizeOf(attr.type) * attr.size;
+        stride += sizeOf(attr);
     }
+    stride = alignUp(stride, max_alignment);
 }
 
 UniformBase::UniformBase(UniformBase && other)
@@ -166,6 +207,10 @@ UniformBase & UniformBase::operator=(UniformBase && other) {
     return *this;
 }
 
+void UniformInt::set(int value) {
+    glUniform1i(location, value);
+}
+
 void UniformFloat::set(float value) {
     glUniform1f(location, value);
 }
@@ -200,6 +245,18 @@ void UniformTexture::set(Texture2D const & texture) {
     glUniform1i(location, texture_block);
 }
 
+void UniformTexture::set(TextureAtlas const & atlas) {
+    glActiveTexture(GL_TEXTURE0 + texture_block);
+    atlas.bind();
+    glUniform1i(location, texture_block);
+}
+
+void UniformTexture::set(StreamedTexture const & texture) {
+    glActiveTexture(GL_TEXTURE0 + texture_block);
+    texture.bind();
+    glUniform1i(location, texture_block);
+}
+
 UniformSimpleMaterial::UniformSimpleMaterial(Program & program)
     : ambient(program.uniformLocation("uMaterial.ambient"))
     , diffuse(program.uniformLocation("uMaterial.diffuse"))
@@ -226,6 +283,34 @@ void UniformMaterial::set(Material const & material) {
     shininess.set(material.shininess);
 }
 
+UniformMaterialBatch::UniformMaterialBatch(Program & program, MaterialBatch::Mode mode, int diffuse_texture_block, int specular_texture_block)
+    : mode(mode)
+    , diffuse(program.uniformLocation(mode == MaterialBatch::Mode::Bindless ? "uMaterialDiffuse[0]" : "uMaterialDiffuse"))
+    , specular(program.uniformLocation(mode == MaterialBatch::Mode::Bindless ? "uMaterialSpecular[0]" : "uMaterialSpecular"))
+    , shininess(program.uniformLocation("uMaterialShininess[0]"))
+    , diffuse_texture_block(diffuse_texture_block)
+    , specular_texture_block(specular_texture_block)
+{}
+
+void UniformMaterialBatch::set(MaterialBatch const & batch) {
+    REQUIRE(batch.mode() == mode, "Material batch mode does not match the program");
+    glUniform1fv(shininess, GLsizei(batch.size()), batch.shininess.data());
+
+    if (mode == MaterialBatch::Mode::Bindless) {
+        glUniformHandleui64vARB(diffuse, GLsizei(batch.size()), batch.diffuse_handles.data());
+        glUniformHandleui64vARB(specular, GLsizei(batch.size()), batch.specular_handles.data());
+        return;
+    }
+
+    glActiveTexture(GLenum(GL_TEXTURE0 + diffuse_texture_block));
+    batch.diffuse_array->bind();
+    glUniform1i(diffuse, diffuse_texture_block);
+
+    glActiveTexture(GLenum(GL_TEXTURE0 + specular_texture_block));
+    batch.specular_array->bind();
+    glUniform1i(specular, specular_texture_block);
+}
+
 UniformLightComponents::UniformLightComponents(Program & program, char const * prefix)
     : ambient(program.uniformLocation(prefix + ".ambient"s))
     , diffuse(program.uniformLocation(prefix + ".diffuse"s))
@@ -318,14 +403,32 @@ void UniformSpotLight::set(SpotLight const & light) {
 }
 
 void Program::enableAttributes() const {
-    for (auto const & attr : attributes) {
-        glVertexAttribPointer(attr.location, attr.size, toGL(attr.type), attr.normalize, stride, (const GLvoid *)attr.offset);
+    for (auto const & attr : layout.attributes) {
+        glVertexAttribPointer(attr.location, attr.size, toGL(attr.type), attr.normalize, layout.stride, (const GLvoid *)attr.offset);
         glEnableVertexAttribArray(attr.location);
     }
 }
 
+void Program::enableAttributeFormats(unsigned int binding) const {
+    for (auto const & attr : layout.attributes) {
+        auto location = static_cast<GLuint>(attr.location);
+        glVertexAttribFormat(location, static_cast<GLint>(attr.size), toGL(attr.type), attr.normalize, static_cast<GLuint>(attr.offset));
+        glVertexAttribBinding(location, binding);
+        glEnableVertexAttribArray(location);
+    }
+}
+
+void Program::enableAttributeFormats(unsigned int vao, unsigned int binding) const {
+    for (auto const & attr : layout.attributes) {
+        auto location = static_cast<GLuint>(attr.location);
+        glVertexArrayAttribFormat(vao, location, static_cast<GLint>(attr.size), toGL(attr.type), attr.normalize, static_cast<GLuint>(attr.offset));
+        glVertexArrayAttribBinding(vao, location, binding);
+        glEnableVertexArrayAttrib(vao, location);
+    }
+}
+
 void Program::disableAttributes() const {
-    for (auto const & attr : attributes)
+    for (auto const & attr : layout.attributes)
         glDisableVertexAttribArray(attr.location);
 }
 
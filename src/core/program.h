@@ -5,7 +5,9 @@
 #include "attribute.h"
 #include "light.h"
 #include "material.h"
+#include "material_batch.h"
 #include "texture.h"
+#include "texture_atlas.h"
 
 #include <string>
 #include <vector>
@@ -13,6 +15,8 @@
 
 namespace core {
 
+class StreamedTexture;
+
 class Program : internal::Resource {
 public:
     DEFAULT_MOVABLE(Program);
@@ -29,16 +33,24 @@ public:
 
     int uniformLocation(char const * name) const;
     int uniformLocation(std::string const & name) const;
+    // The uniform block `name` reads from the buffer range bound to uniform binding point `binding`.
+    void bindUniformBlock(char const * name, unsigned int binding) const;
 
     void enableAttributes() const;
     void disableAttributes() const;
 
+    // GL 4.3 vertex attrib binding: describes the attributes of the bound VAO
+    // without referring to a buffer, all of them are read from `binding`.
+    void enableAttributeFormats(unsigned int binding) const;
+    // The same for GL 4.5 direct state access, `vao` does not have to be bound.
+    void enableAttributeFormats(unsigned int vao, unsigned int binding) const;
+    VertexLayout const & vertexLayout() const noexcept { return layout; }
+
 private:
     int attributeLocation(char const * name) const;
     void loadAttributes(std::vector<Attribute> const & attrs);
 
-    std::vector<LocatedAttribute> attributes;
-    unsigned int stride = 0;
+    VertexLayout layout;
 };
 
 class UniformBase {
@@ -54,6 +66,11 @@ protected:
     int location;
 };
 
+struct UniformInt : UniformBase {
+    UniformInt(int location) : UniformBase(location) {}
+    void set(int value);
+};
+
 struct UniformFloat : UniformBase {
     UniformFloat(int location) : UniformBase(location) {}
     void set(float value);
@@ -96,6 +113,8 @@ struct UniformTexture : UniformBase {
     {}
 
     void set(Texture2D const & texture);
+    void set(TextureAtlas const & atlas);
+    void set(StreamedTexture const & texture);
 private:
     int texture_block;
 };
@@ -119,6 +138,18 @@ private:
     UniformFloat shininess;
 };
 
+struct UniformMaterialBatch {
+    UniformMaterialBatch(Program & program, MaterialBatch::Mode mode, int diffuse_texture_block, int specular_texture_block);
+    void set(MaterialBatch const & batch);
+private:
+    MaterialBatch::Mode mode;
+    int diffuse;
+    int specular;
+    int shininess;
+    int diffuse_texture_block;
+    int specular_texture_block;
+};
+
 struct UniformLightComponents {
     UniformLightComponents(Program & program, char const * prefix);
     void set(LightComponents const & light);
@@ -0,0 +1,125 @@
+#include "stream_ring_buffer.h"
+#include "internal/features.h"
+#include "opengl.h"
+#include "exception.h"
+
+#include <cassert>
+
+namespace core {
+
+namespace {
+
+constexpr GLbitfield STREAM_MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+// Waits are a second long and give up after a few, so a lost context does not hang the client.
+constexpr GLuint64 FENCE_TIMEOUT_NS = 1'000'000'000;
+constexpr size_t FENCE_TIMEOUTS = 5;
+
+GLenum toGL(StreamTarget target) {
+    switch (target) {
+        case StreamTarget::Vertex  : return GL_ARRAY_BUFFER;
+        case StreamTarget::Index   : return GL_ELEMENT_ARRAY_BUFFER;
+        case StreamTarget::Uniform : return GL_UNIFORM_BUFFER;
+        case StreamTarget::PixelUnpack : return GL_PIXEL_UNPACK_BUFFER;
+        default: assert(false && "unreachable");
+    }
+}
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+StreamRingBuffer::StreamRingBuffer(size_t region_size, size_t regions)
+    : region_size(region_size)
+    , fences(regions, nullptr)
+    , memory(region_size * regions)
+{
+    REQUIRE(region_size > 0 && regions > 0, "Stream ring buffer cannot be empty");
+    REQUIRE(supported(), "Stream ring buffer needs GL 4.4 or ARB_buffer_storage");
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0)
+        uniform_alignment = static_cast<size_t>(alignment);
+
+    auto total_size = static_cast<GLsizeiptr>(region_size * regions);
+    if (internal::hasDirectStateAccess()) {
+        glCreateBuffers(1, &id);
+        entry = { internal::bufferPool(), id, { region_size * regions } };
+        glNamedBufferStorage(id, total_size, nullptr, STREAM_MAP_FLAGS);
+        mapped = static_cast<std::byte *>(glMapNamedBufferRange(id, 0, total_size, STREAM_MAP_FLAGS));
+        REQUIRE(mapped, "Cannot map stream ring buffer");
+        return;
+    }
+
+    glGenBuffers(1, &id);
+    entry = { internal::bufferPool(), id, { region_size * regions } };
+    glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, total_size, nullptr, STREAM_MAP_FLAGS);
+    mapped = static_cast<std::byte *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total_size, STREAM_MAP_FLAGS));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    REQUIRE(mapped, "Cannot map stream ring buffer");
+}
+
+StreamRingBuffer::~StreamRingBuffer() {
+    for (auto * fence : fences)
+        glDeleteSync(static_cast<GLsync>(fence));
+    // The buffer goes with `entry`, deleting it unmaps it.
+}
+
+bool StreamRingBuffer::supported() {
+    return internal::hasBufferStorage();
+}
+
+void StreamRingBuffer::beginFrame() {
+    auto fence = static_cast<GLsync>(fences[region]);
+    if (fence) {
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        for (size_t timeouts = 0;; ++timeouts) {
+            REQUIRE(timeouts < FENCE_TIMEOUTS, "GPU has not finished reading a stream ring buffer region in time");
+            GLenum status = glClientWaitSync(fence, flags, FENCE_TIMEOUT_NS);
+            REQUIRE(status != GL_WAIT_FAILED, "Waiting for stream ring buffer region failed");
+            if (status != GL_TIMEOUT_EXPIRED)
+                break;
+            flags = 0;
+        }
+        glDeleteSync(fence);
+        fences[region] = nullptr;
+    }
+    cursor = 0;
+}
+
+void StreamRingBuffer::endFrame() {
+    assert(!fences[region]);
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % fences.size();
+    cursor = 0;
+}
+
+StreamRingBuffer::Allocation StreamRingBuffer::allocate(size_t size, size_t alignment) {
+    // Bindings check the offset from the start of the buffer, regions need not be aligned.
+    size_t region_start = region * region_size;
+    size_t buffer_offset = alignUp(region_start + cursor, alignment);
+    REQUIRE(buffer_offset + size <= region_start + region_size, "Stream ring buffer region is exhausted");
+    cursor = buffer_offset + size - region_start;
+
+    return { mapped + buffer_offset, buffer_offset, size };
+}
+
+void StreamRingBuffer::bind(StreamTarget target) const {
+    glBindBuffer(toGL(target), id);
+}
+
+void StreamRingBuffer::bindRange(StreamTarget target, unsigned int index, Allocation const & allocation) const {
+    assert(target == StreamTarget::Uniform && "only uniform blocks have indexed binding points");
+    assert(allocation.offset % uniform_alignment == 0);
+    glBindBufferRange(toGL(target), index, id, static_cast<GLintptr>(allocation.offset), static_cast<GLsizeiptr>(allocation.size));
+}
+
+void StreamRingBuffer::bindVertexBuffer(unsigned int binding, Allocation const & allocation, size_t stride) const {
+    glBindVertexBuffer(binding, id, static_cast<GLintptr>(allocation.offset), static_cast<GLsizei>(stride));
+}
+
+} // namespace core
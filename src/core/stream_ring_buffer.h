@@ -0,0 +1,71 @@
+#pragma once
+
+#include "internal/gl_objects.h"
+#include "internal/resource.h"
+#include "gpu_memory.h"
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace core {
+
+enum class StreamTarget { Vertex, Index, Uniform, PixelUnpack };
+
+// A persistently mapped buffer split into one region per frame in flight.
+// A frame writes straight into its own region, which is fenced when the frame
+// ends and is not written again until the GPU has finished reading it.
+class StreamRingBuffer : internal::Resource {
+public:
+    static constexpr size_t DEFAULT_ALIGNMENT = 16;
+
+    struct Allocation {
+        std::byte * data;
+        // From the start of the buffer, this is what draws and bindings need.
+        size_t offset;
+        size_t size;
+    };
+
+    StreamRingBuffer(size_t region_size, size_t regions = 3);
+    ~StreamRingBuffer();
+
+    // Needs buffers which can stay mapped, GL 4.4 or ARB_buffer_storage.
+    static bool supported();
+
+    // Waits until the GPU is done with the current region, so it can be written again.
+    void beginFrame();
+    // Fences the commands which read the current region and moves on to the next one.
+    void endFrame();
+
+    Allocation allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+
+    template<class T>
+    Allocation write(std::span<T const> data, size_t alignment = DEFAULT_ALIGNMENT) {
+        auto allocation = allocate(data.size_bytes(), alignment);
+        std::memcpy(allocation.data, data.data(), data.size_bytes());
+        return allocation;
+    }
+
+    // Offsets of uniform ranges have to be a multiple of this.
+    size_t uniformAlignment() const noexcept { return uniform_alignment; }
+
+    void bind(StreamTarget target) const;
+    // Binds an allocation to an indexed uniform block binding point.
+    void bindRange(StreamTarget target, unsigned int index, Allocation const & allocation) const;
+    // GL 4.3 vertex attrib binding: attaches an allocation to `binding` of the bound VAO.
+    void bindVertexBuffer(unsigned int binding, Allocation const & allocation, size_t stride) const;
+
+private:
+    std::byte * mapped = nullptr;
+    size_t region_size;
+    size_t region = 0;
+    size_t cursor = 0;
+    size_t uniform_alignment = DEFAULT_ALIGNMENT;
+    std::vector<void *> fences;
+    internal::GpuAllocation memory;
+    // Owns the buffer, `id` is its name.
+    internal::PoolEntry<internal::BufferInfo> entry;
+};
+
+} // namespace core
@@ -1,23 +1,83 @@
 #include "texture.h"
+#include "block_compression.h"
+#include "image_kernels.h"
+#include "internal/features.h"
+#include "texture_residency.h"
 #include "opengl.h"
+#include "exception.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
 
 namespace core {
 
 namespace {
 GLenum toGL(Image::Format format) {
     switch (format) {
+    case Image::Format::R8:
+    case Image::Format::R16:
+    case Image::Format::R16F:
+    case Image::Format::R32F: return GL_RED;
+    case Image::Format::RG8: return GL_RG;
     case Image::Format::RGB: return GL_RGB;
-    case Image::Format::RGBA: return GL_RGBA;
+    case Image::Format::RGBA:
+    case Image::Format::RGBA16:
+    case Image::Format::RGBA16F:
+    case Image::Format::RGBA32F: return GL_RGBA;
+    default: assert(false && "unreachable");
     }
 }
 
-GLint toGLInternalFormat(Image::Format format) {
+GLenum toGLType(Image::Format format) {
     switch (format) {
-    case Image::Format::RGB: return GL_RGB;
-    case Image::Format::RGBA: return GL_RGBA;
+    case Image::Format::R16:
+    case Image::Format::RGBA16: return GL_UNSIGNED_SHORT;
+    case Image::Format::R16F:
+    case Image::Format::RGBA16F: return GL_HALF_FLOAT;
+    case Image::Format::R32F:
+    case Image::Format::RGBA32F: return GL_FLOAT;
+    default: return GL_UNSIGNED_BYTE;
+    }
+}
+
+// Immutable storage needs sized formats. sRGB ones are decoded to linear when sampled.
+GLenum toGLSizedFormat(Image::Format format, bool srgb) {
+    switch (format) {
+    case Image::Format::RGB: return srgb ? GL_SRGB8 : GL_RGB8;
+    case Image::Format::RGBA: return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    case Image::Format::BC1: return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case Image::Format::BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    // A single channel has no sRGB variant, it is rarely a color anyway.
+    case Image::Format::BC4: return GL_COMPRESSED_RED_RGTC1;
+    case Image::Format::BC7: return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    // Data rather than colors, so never sRGB.
+    case Image::Format::R8: return GL_R8;
+    case Image::Format::RG8: return GL_RG8;
+    case Image::Format::R16: return GL_R16;
+    case Image::Format::RGBA16: return GL_RGBA16;
+    case Image::Format::R16F: return GL_R16F;
+    case Image::Format::RGBA16F: return GL_RGBA16F;
+    case Image::Format::R32F: return GL_R32F;
+    case Image::Format::RGBA32F: return GL_RGBA32F;
+    }
+}
+
+// RGTC is core since GL 3.0, the other block formats need extensions.
+bool isSupported(Image::Format format, bool srgb) {
+    switch (format) {
+    case Image::Format::BC1:
+    case Image::Format::BC3: return srgb ? internal::hasSrgbS3tcCompression() : internal::hasS3tcCompression();
+    case Image::Format::BC7: return internal::hasBptcCompression();
+    default: return true;
     }
 }
 
+// Drivers keep RGB textures as RGBA, so this is what they really take.
+size_t gpuBytesOf(Image::Format format, size_t width, size_t height) {
+    return format == Image::Format::RGB ? width * height * 4 : bytesOf(format, width, height);
+}
+
 GLint toGl(Texture2D::Wrap::Type type) {
     switch (type) {
     case Texture2D::Wrap::Type::Repeat:         return GL_REPEAT;
@@ -31,32 +91,493 @@ GLint toGl(Texture2D::Filter type) {
     switch (type) {
         case Texture2D::Filter::Nearest: return GL_NEAREST;
         case Texture2D::Filter::Linear: return GL_LINEAR;
+        case Texture2D::Filter::NearestMipmapNearest: return GL_NEAREST_MIPMAP_NEAREST;
+        case Texture2D::Filter::LinearMipmapNearest: return GL_LINEAR_MIPMAP_NEAREST;
+        case Texture2D::Filter::NearestMipmapLinear: return GL_NEAREST_MIPMAP_LINEAR;
+        case Texture2D::Filter::LinearMipmapLinear: return GL_LINEAR_MIPMAP_LINEAR;
     }
 }
 
+bool usesMipmaps(Texture2D::Filter type) {
+    return type != Texture2D::Filter::Nearest && type != Texture2D::Filter::Linear;
+}
+
+size_t levelsOf(size_t width, size_t height, Texture2D::Config const & config) {
+    REQUIRE(!usesMipmaps(config.magFilter), "Magnification filter cannot use mipmaps");
+    REQUIRE(config.mipmaps != Texture2D::Mipmaps::None || !usesMipmaps(config.minFilter),
+        "Mipmap filtering needs a texture with mipmaps");
+    if (config.mipmaps == Texture2D::Mipmaps::None)
+        return 1;
+    size_t levels = mipLevelsOf(width, height);
+    return config.maxLevels == 0 ? levels : std::min(levels, config.maxLevels);
+}
+
+// All the mip levels down to 1x1 together take a third more.
+size_t gpuBytesOf(Image::Format format, size_t width, size_t height, size_t levels) {
+    size_t total = 0;
+    for (size_t level = 0; level < levels; ++level) {
+        total += gpuBytesOf(format, width, height);
+        width = std::max<size_t>(width / 2, 1);
+        height = std::max<size_t>(height / 2, 1);
+    }
+    return total;
+}
+
+// Rows of tightly packed pixels are not always 4-byte aligned, e.g. small RGB mips.
+struct UnpackAlignment {
+    explicit UnpackAlignment(size_t row_bytes)
+        : packed(row_bytes % 4 != 0)
+    {
+        if (packed)
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
+
+    ~UnpackAlignment() {
+        if (packed)
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    UnpackAlignment(UnpackAlignment const &) = delete;
+    UnpackAlignment & operator=(UnpackAlignment const &) = delete;
+
+    bool packed;
+};
+
+// Specifies and fills a texture the same way with and without direct state
+// access. Without it the texture stays bound while the editor is alive.
+class TextureEditor {
+public:
+    // Creates the texture unless `id` names one already.
+    TextureEditor(GLenum target, GLuint & id)
+        : target(target)
+        , id(id)
+        , dsa(internal::hasDirectStateAccess())
+        , immutable(dsa || internal::hasTextureStorage())
+    {
+        if (id == 0 && dsa) {
+            glCreateTextures(target, 1, &id);
+            return;
+        }
+        if (id == 0)
+            glGenTextures(1, &id);
+        if (!dsa)
+            glBindTexture(target, id);
+    }
+
+    ~TextureEditor() {
+        if (!dsa)
+            glBindTexture(target, 0);
+    }
+
+    TextureEditor(TextureEditor const &) = delete;
+    TextureEditor & operator=(TextureEditor const &) = delete;
+
+    // Immutable storage is allocated and validated once, otherwise every level is specified on its own.
+    void storage2D(size_t levels, GLenum internal_format, size_t width, size_t height) {
+        if (dsa) {
+            glTextureStorage2D(id, GLsizei(levels), internal_format, GLsizei(width), GLsizei(height));
+            return;
+        }
+        if (immutable) {
+            glTexStorage2D(target, GLsizei(levels), internal_format, GLsizei(width), GLsizei(height));
+            return;
+        }
+        for (size_t level = 0; level < levels; ++level) {
+            glTexImage2D(target, GLint(level), GLint(internal_format), GLsizei(width), GLsizei(height), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            width = std::max<size_t>(width / 2, 1);
+            height = std::max<size_t>(height / 2, 1);
+        }
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, GLint(levels - 1));
+    }
+
+    void storage3D(size_t levels, GLenum internal_format, size_t width, size_t height, size_t depth) {
+        if (dsa) {
+            glTextureStorage3D(id, GLsizei(levels), internal_format, GLsizei(width), GLsizei(height), GLsizei(depth));
+            return;
+        }
+        if (immutable) {
+            glTexStorage3D(target, GLsizei(levels), internal_format, GLsizei(width), GLsizei(height), GLsizei(depth));
+            return;
+        }
+        for (size_t level = 0; level < levels; ++level) {
+            glTexImage3D(target, GLint(level), GLint(internal_format), GLsizei(width), GLsizei(height), GLsizei(depth), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            width = std::max<size_t>(width / 2, 1);
+            height = std::max<size_t>(height / 2, 1);
+        }
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, GLint(levels - 1));
+    }
+
+    // Without immutable storage the levels are specified by `compressed2D`.
+    void compressedStorage2D(size_t levels, GLenum internal_format, size_t width, size_t height) {
+        if (immutable) {
+            storage2D(levels, internal_format, width, height);
+            return;
+        }
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, GLint(levels - 1));
+    }
+
+    void compressed2D(size_t level, GLenum internal_format, size_t width, size_t height, std::span<std::byte const> blocks) {
+        if (dsa) {
+            glCompressedTextureSubImage2D(id, GLint(level), 0, 0, GLsizei(width), GLsizei(height), internal_format, GLsizei(blocks.size()), blocks.data());
+        } else if (immutable) {
+            glCompressedTexSubImage2D(target, GLint(level), 0, 0, GLsizei(width), GLsizei(height), internal_format, GLsizei(blocks.size()), blocks.data());
+        } else {
+            glCompressedTexImage2D(target, GLint(level), internal_format, GLsizei(width), GLsizei(height), 0, GLsizei(blocks.size()), blocks.data());
+        }
+    }
+
+    void image2D(size_t level, Image const & image) {
+        pixels2D(level, image.width, image.height, image.format, image.image.data());
+    }
+
+    void pixels2D(size_t level, size_t width, size_t height, Image::Format format, void const * pixels) {
+        rows2D(level, 0, width, height, format, pixels);
+    }
+
+    // Drivers mostly convert RGB to RGBA on the CPU, a pixel at a time. Expanding
+    // the rows here is faster and keeps them 4-byte aligned.
+    void rows2D(size_t level, size_t y, size_t width, size_t rows, Image::Format format, void const * pixels) {
+        if (format == Image::Format::RGB) {
+            pixels = expanded(width * rows, pixels);
+            format = Image::Format::RGBA;
+        }
+        unpackRows2D(level, y, width, rows, format, pixels);
+    }
+
+    // Rows handed to GL as they are, e.g. as an offset into the bound pixel unpack buffer.
+    void unpackRows2D(size_t level, size_t y, size_t width, size_t rows, Image::Format format, void const * pixels) {
+        UnpackAlignment alignment(width * bytesPerPixelOf(format));
+        if (dsa) {
+            glTextureSubImage2D(id, GLint(level), 0, GLint(y), GLsizei(width), GLsizei(rows), toGL(format), toGLType(format), pixels);
+        } else {
+            glTexSubImage2D(target, GLint(level), 0, GLint(y), GLsizei(width), GLsizei(rows), toGL(format), toGLType(format), pixels);
+        }
+    }
+
+    void image3D(size_t level, size_t layer, Image const & image) {
+        void const * pixels = image.image.data();
+        Image::Format format = image.format;
+        if (format == Image::Format::RGB) {
+            pixels = expanded(image.width * image.height, pixels);
+            format = Image::Format::RGBA;
+        }
+        UnpackAlignment alignment(image.width * bytesPerPixelOf(format));
+        if (dsa) {
+            glTextureSubImage3D(id, GLint(level), 0, 0, GLint(layer), GLsizei(image.width), GLsizei(image.height), 1, toGL(format), toGLType(format), pixels);
+        } else {
+            glTexSubImage3D(target, GLint(level), 0, 0, GLint(layer), GLsizei(image.width), GLsizei(image.height), 1, toGL(format), toGLType(format), pixels);
+        }
+    }
+
+    void generateMipmaps() {
+        if (dsa) {
+            glGenerateTextureMipmap(id);
+        } else {
+            glGenerateMipmap(target);
+        }
+    }
+
+    // Gamma-correct mip chain computed on the CPU, `upload(level, image)` stores each level.
+    template<class Upload>
+    void downsampleMipmaps(Image const & base, size_t levels, Upload upload) {
+        if (levels <= 1)
+            return;
+        Image level = downsampled(base, true);
+        for (size_t i = 1; i < levels; ++i) {
+            upload(i, level);
+            if (i + 1 < levels)
+                level = downsampled(level, true);
+        }
+    }
+
+    void parameters(Texture2D::Config const & config) {
+        parameter(GL_TEXTURE_WRAP_S, toGl(config.wrap.s));
+        parameter(GL_TEXTURE_WRAP_T, toGl(config.wrap.t));
+
+        parameter(GL_TEXTURE_MIN_FILTER, toGl(config.minFilter));
+        parameter(GL_TEXTURE_MAG_FILTER, toGl(config.magFilter));
+
+        if (config.anisotropy > 1.0f && internal::hasAnisotropicFiltering()) {
+            GLfloat max_anisotropy = 1.0f;
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_anisotropy);
+            GLfloat anisotropy = std::min(config.anisotropy, max_anisotropy);
+            if (dsa) {
+                glTextureParameterf(id, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+            } else {
+                glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+            }
+        }
+    }
+
+    void baseLevel(size_t level) {
+        parameter(GL_TEXTURE_BASE_LEVEL, GLint(level));
+    }
+
+    // One channel is sampled as grey instead of red, two as grey with alpha.
+    void swizzle(Image::Format format) {
+        size_t channels = format == Image::Format::BC4 ? 1 : isCompressed(format) ? 0 : channelsOf(format);
+        if (channels != 1 && channels != 2)
+            return;
+        GLint swizzle[] = { GL_RED, GL_RED, GL_RED, channels == 1 ? GL_ONE : GL_GREEN };
+        if (dsa) {
+            glTextureParameteriv(id, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        } else {
+            glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        }
+    }
+
+private:
+    // RGBA copy of `count` RGB pixels, valid until the next call.
+    std::byte const * expanded(size_t count, void const * rgb) {
+        scratch.resize(count * 4);
+        kernels::expandRgbToRgba({ static_cast<std::byte const *>(rgb), count * 3 }, scratch);
+        return scratch.data();
+    }
+
+    void parameter(GLenum name, GLint value) {
+        if (dsa) {
+            glTextureParameteri(id, name, value);
+        } else {
+            glTexParameteri(target, name, value);
+        }
+    }
+
+    GLenum target;
+    GLuint & id;
+    bool dsa;
+    bool immutable;
+    std::vector<std::byte> scratch;
+};
+
+// Blocks the driver cannot sample are decoded on the CPU into `pixels`.
+BakedImage decompressedLevels(BakedImage const & image, std::vector<std::byte> & pixels) {
+    BakedImage result = image;
+    size_t width = image.width;
+    size_t height = image.height;
+    size_t offset = 0;
+    for (size_t level = 0; level < image.levels; ++level) {
+        size_t size = bytesOf(image.format, width, height);
+        REQUIRE(offset + size <= image.pixels.size(), "Baked image is shorter than its mip chain");
+        auto decoded = decompressed(image.format, width, height, image.pixels.subspan(offset, size));
+        pixels.insert(pixels.end(), decoded.image.begin(), decoded.image.end());
+        result.format = decoded.format;
+        offset += size;
+        width = std::max<size_t>(width / 2, 1);
+        height = std::max<size_t>(height / 2, 1);
+    }
+    result.pixels = pixels;
+    return result;
+}
+
 } // namespace
 
-Texture2D::Texture2D(const Image& image, Config config) {
-    glGenTextures(1, &id);
+Texture2D::Texture2D(const Image& image, Config config)
+    : level_count(levelsOf(image.width, image.height, config))
+    , memory(gpuBytesOf(image.format, image.width, image.height, level_count))
+{
+    REQUIRE(!isCompressed(image.format), "Compressed images are uploaded with their baked mip chain");
+    size_t levels = level_count;
 
-    bind();
+    GLenum internal_format = toGLSizedFormat(image.format, config.srgb);
+    TextureEditor editor(GL_TEXTURE_2D, id);
+    entry = { internal::texturePool(), id, { image.width, image.height, 1, internal_format } };
 
-    glTexImage2D(GL_TEXTURE_2D, 0, toGLInternalFormat(image.format), GLsizei(image.width), GLsizei(image.height), 0, toGL(image.format), GL_UNSIGNED_BYTE, image.image.data());
+    editor.storage2D(levels, internal_format, image.width, image.height);
+    editor.image2D(0, image);
+    if (config.mipmaps == Mipmaps::Generate)
+        editor.generateMipmaps();
+    if (config.mipmaps == Mipmaps::GammaCorrect)
+        editor.downsampleMipmaps(image, levels, [&](size_t level, Image const & mip) { editor.image2D(level, mip); });
+    editor.swizzle(image.format);
+    editor.parameters(config);
+}
+
+Texture2D::Texture2D(BakedImage const & baked, Config config)
+    : config(config)
+    , source(baked)
+{
+    upload(0);
+    internal::trackTexture(*this);
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, toGl(config.wrap.s));
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, toGl(config.wrap.t));
+void Texture2D::upload(size_t dropped) {
+    std::vector<std::byte> fallback;
+    BakedImage image = isCompressed(source->format) && !isSupported(source->format, config.srgb) ? decompressedLevels(*source, fallback) : *source;
+    bool compressed = isCompressed(image.format);
+    GLenum internal_format = toGLSizedFormat(image.format, config.srgb);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, toGl(config.minFilter));
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, toGl(config.magFilter));
+    size_t levels = levelsOf(image.width, image.height, config);
+    // Drivers cannot generate mips of compressed textures.
+    REQUIRE(!compressed || image.levels >= levels, "Compressed images should be baked with their whole mip chain");
+    REQUIRE(dropped < std::max<size_t>(std::min(levels, image.levels), 1), "Only baked levels can become the base level");
 
-    unbind();
+    // The dropped levels are skipped in the baked chain.
+    size_t width = image.width;
+    size_t height = image.height;
+    size_t offset = 0;
+    for (size_t level = 0; level < dropped; ++level) {
+        offset += bytesOf(image.format, width, height);
+        width = std::max<size_t>(width / 2, 1);
+        height = std::max<size_t>(height / 2, 1);
+    }
+    level_count = levels - dropped;
+    dropped_levels = dropped;
+    stored_format = image.format;
+    memory.resize(gpuBytesOf(image.format, width, height, level_count));
+
+    TextureEditor editor(GL_TEXTURE_2D, id);
+    entry = { internal::texturePool(), id, { width, height, 1, internal_format } };
+
+    if (compressed) {
+        editor.compressedStorage2D(level_count, internal_format, width, height);
+    } else {
+        editor.storage2D(level_count, internal_format, width, height);
+    }
+
+    // The baked mip chain is used as it is, only missing levels are generated.
+    size_t baked_levels = std::min(levels, image.levels) - dropped;
+    for (size_t level = 0; level < baked_levels; ++level) {
+        size_t size = bytesOf(image.format, width, height);
+        REQUIRE(offset + size <= image.pixels.size(), "Baked image is shorter than its mip chain");
+        if (compressed) {
+            editor.compressed2D(level, internal_format, width, height, image.pixels.subspan(offset, size));
+        } else {
+            editor.pixels2D(level, width, height, image.format, image.pixels.data() + offset);
+        }
+        offset += size;
+        width = std::max<size_t>(width / 2, 1);
+        height = std::max<size_t>(height / 2, 1);
+    }
+    if (baked_levels < level_count)
+        editor.generateMipmaps();
+
+    editor.swizzle(image.format);
+    editor.parameters(config);
+}
+
+void Texture2D::evict() {
+    entry = {};
+    id = 0;
+    memory.resize(0);
+}
+
+size_t Texture2D::maxDroppedLevels() const {
+    if (!source)
+        return 0;
+    return std::min(levelsOf(source->width, source->height, config), source->levels) - 1;
+}
+
+size_t Texture2D::bytesWithout(size_t dropped) const {
+    size_t width = std::max<size_t>(source->width >> dropped, 1);
+    size_t height = std::max<size_t>(source->height >> dropped, 1);
+    return gpuBytesOf(stored_format, width, height, levelsOf(source->width, source->height, config) - dropped);
+}
+
+Texture2D::Texture2D(size_t width, size_t height, Image::Format format, Config config)
+    : level_count(levelsOf(width, height, config))
+    , memory(gpuBytesOf(format, width, height, level_count))
+{
+    REQUIRE(!isCompressed(format), "Compressed textures are uploaded with their baked mip chain");
+
+    GLenum internal_format = toGLSizedFormat(format, config.srgb);
+    TextureEditor editor(GL_TEXTURE_2D, id);
+    entry = { internal::texturePool(), id, { width, height, 1, internal_format } };
+
+    editor.storage2D(level_count, internal_format, width, height);
+    editor.swizzle(format);
+    editor.parameters(config);
 }
 
 Texture2D::~Texture2D() {
-    glDeleteTextures(1, &id);
+    if (source)
+        internal::untrackTexture(*this);
 }
 
-void Texture2D::bind() const { glBindTexture(GL_TEXTURE_2D, id); }
+void Texture2D::bind() const {
+    if (source)
+        internal::useTexture(*this);
+    glBindTexture(GL_TEXTURE_2D, id);
+}
 void Texture2D::unbind() { glBindTexture(GL_TEXTURE_2D, 0); }
 
+void Texture2D::update(size_t level, size_t y, size_t rows, Image::Format format, void const * pixels) {
+    REQUIRE(level < level_count, "Texture has no such level");
+    auto const & info = entry.meta();
+    size_t width = std::max<size_t>(info.width >> level, 1);
+    size_t height = std::max<size_t>(info.height >> level, 1);
+    REQUIRE(y + rows <= height, "Rows are out of the texture level");
+
+    TextureEditor editor(GL_TEXTURE_2D, id);
+    editor.rows2D(level, y, width, rows, format, pixels);
+}
+
+void Texture2D::updateFromBuffer(size_t level, size_t y, size_t rows, Image::Format format, size_t offset) {
+    REQUIRE(level < level_count, "Texture has no such level");
+    auto const & info = entry.meta();
+    size_t width = std::max<size_t>(info.width >> level, 1);
+    size_t height = std::max<size_t>(info.height >> level, 1);
+    REQUIRE(y + rows <= height, "Rows are out of the texture level");
+
+    TextureEditor editor(GL_TEXTURE_2D, id);
+    editor.unpackRows2D(level, y, width, rows, format, reinterpret_cast<void const *>(offset));
+}
+
+void Texture2D::setBaseLevel(size_t level) {
+    REQUIRE(level < level_count, "Texture has no such level");
+    TextureEditor editor(GL_TEXTURE_2D, id);
+    editor.baseLevel(level);
+}
+
+uint64_t Texture2D::bindlessHandle() const {
+    REQUIRE(GLEW_ARB_bindless_texture, "Bindless textures are not supported");
+    if (source) {
+        internal::useTexture(*this);
+        internal::pinTexture(*this);
+    }
+    return glGetTextureHandleARB(id);
+}
+
+Texture2DArray::Texture2DArray(std::span<Image const * const> layers, Texture2D::Config config)
+    : layer_count(layers.size())
+{
+    REQUIRE(!layers.empty(), "Texture array should have at least one layer");
+    size_t width = layers.front()->width;
+    size_t height = layers.front()->height;
+    size_t levels = levelsOf(width, height, config);
+    // Every layer takes the format of the first one.
+    auto format = layers.front()->format == Image::Format::RGB ? Image::Format::RGBA : layers.front()->format;
+    memory.resize(gpuBytesOf(format, width, height, levels) * layer_count);
+
+    GLenum internal_format = toGLSizedFormat(format, config.srgb);
+    TextureEditor editor(GL_TEXTURE_2D_ARRAY, id);
+    entry = { internal::texturePool(), id, { width, height, layer_count, internal_format } };
+
+    editor.storage3D(levels, internal_format, width, height, layer_count);
+    for (size_t layer = 0; layer < layer_count; ++layer) {
+        auto const * image = layers[layer];
+        REQUIRE(!isCompressed(image->format), "Texture array layers should not be compressed");
+        Image scaled;
+        // RGB rows are expanded to RGBA on their way anyway.
+        if (image->format != format && !(image->format == Image::Format::RGB && format == Image::Format::RGBA)) {
+            scaled = converted(*image, format);
+            image = &scaled;
+        }
+        if (image->width != width || image->height != height) {
+            scaled = resized(*image, width, height);
+            image = &scaled;
+        }
+        editor.image3D(0, layer, *image);
+        if (config.mipmaps == Texture2D::Mipmaps::GammaCorrect)
+            editor.downsampleMipmaps(*image, levels, [&](size_t level, Image const & mip) { editor.image3D(level, layer, mip); });
+    }
+    if (config.mipmaps == Texture2D::Mipmaps::Generate)
+        editor.generateMipmaps();
+
+    editor.swizzle(format);
+    editor.parameters(config);
+}
+
+void Texture2DArray::bind() const { glBindTexture(GL_TEXTURE_2D_ARRAY, id); }
+void Texture2DArray::unbind() { glBindTexture(GL_TEXTURE_2D_ARRAY, 0); }
+
 } // namespace core
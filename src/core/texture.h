@@ -1,13 +1,39 @@
 #pragma once
 
+#include "gpu_memory.h"
 #include "image.h"
+#include "internal/gl_objects.h"
 #include "internal/resource.h"
 
+#include <cstdint>
+#include <optional>
+#include <span>
+
 namespace core {
 
+namespace internal {
+struct Residency;
+} // namespace internal
+
 class Texture2D : internal::Resource {
 public:
-    enum class Filter { Nearest, Linear };
+    enum class Filter {
+        Nearest,
+        Linear,
+        // Minification only, these sample the mip chain.
+        NearestMipmapNearest,
+        LinearMipmapNearest,
+        NearestMipmapLinear,
+        LinearMipmapLinear,
+    };
+
+    enum class Mipmaps {
+        None,
+        // glGenerateMipmap, averages the stored values as they are.
+        Generate,
+        // Averaged on the CPU as linear values, so minified textures keep their brightness.
+        GammaCorrect,
+    };
 
     struct Wrap {
         enum class Type {
@@ -27,16 +53,87 @@ public:
     struct Config {
         Config() noexcept {}
         Wrap wrap = { Wrap::Type::Repeat };
-        Filter minFilter = Filter::Linear;
+        Filter minFilter = Filter::LinearMipmapLinear;
         Filter magFilter = Filter::Linear;
+        Mipmaps mipmaps = Mipmaps::GammaCorrect;
+        // Clamped to what the driver supports, 1 turns anisotropic filtering off.
+        float anisotropy = 8.0f;
+        // Caps the mip chain, 0 keeps every level down to 1x1.
+        size_t maxLevels = 0;
+        // Colors are stored as sRGB and sampled as linear values.
+        bool srgb = false;
         // TODO: vec4 borderColor;
     };
 
     Texture2D(const Image& image, Config config = {});
+    // Uploads the baked mip chain straight from the executable. The texture
+    // is reloaded from it after an eviction, see texture_residency.h.
+    Texture2D(BakedImage const & image, Config config = {});
+    // Storage for all the levels, their pixels are set with `update`.
+    Texture2D(size_t width, size_t height, Image::Format format, Config config = {});
     ~Texture2D();
 
+    // Evicted textures are uploaded again first.
+    void bind() const;
+    static void unbind();
+
+    size_t levels() const noexcept { return level_count; }
+
+    // Replaces rows [y, y + rows) of a level.
+    void update(size_t level, size_t y, size_t rows, Image::Format format, void const * pixels);
+    // The same from rows at `offset` in the bound GL_PIXEL_UNPACK_BUFFER, which are never RGB.
+    void updateFromBuffer(size_t level, size_t y, size_t rows, Image::Format format, size_t offset);
+    // Only levels from `level` on are sampled, e.g. while the others are being filled.
+    void setBaseLevel(size_t level);
+
+    // ARB_bindless_texture handle, it has to be made resident before it can be
+    // used by a shader. The texture is never evicted afterwards.
+    uint64_t bindlessHandle() const;
+
+    // Changes whenever an evicted texture is reloaded.
+    internal::TexturePool::Handle handle() const noexcept { return entry.handle(); }
+
+private:
+    friend struct internal::Residency;
+
+    // Creates the texture from its baked image, leaving out the `dropped` largest levels.
+    void upload(size_t dropped);
+    void evict();
+    bool resident() const noexcept { return id != 0; }
+    size_t maxDroppedLevels() const;
+    size_t bytesWithout(size_t dropped) const;
+
+    size_t level_count = 1;
+    Config config;
+    std::optional<BakedImage> source;
+    // What the driver stores, baked blocks it cannot sample are decoded.
+    Image::Format stored_format = Image::Format::RGBA;
+    size_t dropped_levels = 0;
+    // Frame of the last bind and the place among the tracked textures.
+    mutable size_t last_use = 0;
+    size_t residency_slot = 0;
+    bool pinned = false;
+    internal::GpuAllocation memory;
+    // Owns the texture, `id` is its name.
+    internal::PoolEntry<internal::TextureInfo> entry;
+};
+
+// All layers share the size of the first one, other images are resampled to it.
+class Texture2DArray : internal::Resource {
+public:
+    Texture2DArray(std::span<Image const * const> layers, Texture2D::Config config = {});
+
     void bind() const;
     static void unbind();
+
+    size_t layers() const noexcept { return layer_count; }
+    internal::TexturePool::Handle handle() const noexcept { return entry.handle(); }
+
+private:
+    size_t layer_count;
+    internal::GpuAllocation memory;
+    // Owns the texture, `id` is its name.
+    internal::PoolEntry<internal::TextureInfo> entry;
 };
 
 } // namespace core
@@ -0,0 +1,43 @@
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace core {
+
+TextureAtlas::TextureAtlas(std::span<Image const * const> images, Texture2D::Config config, size_t padding, size_t max_size) {
+    auto packed = packAtlas(images, padding, max_size);
+    regions = std::move(packed.regions);
+
+    // Level log2(padding) is the last one with at least a texel of gutter.
+    size_t safe_levels = size_t(std::countr_zero(padding)) + 1;
+    config.maxLevels = config.maxLevels == 0 ? safe_levels : std::min(config.maxLevels, safe_levels);
+    config.wrap = { Texture2D::Wrap::Type::ClampToEdge };
+
+    if (packed.pages.size() == 1) {
+        page.emplace(packed.pages.front(), config);
+        return;
+    }
+    std::vector<Image const *> layers;
+    for (auto const & layer : packed.pages)
+        layers.push_back(&layer);
+    array.emplace(layers, config);
+}
+
+TextureAtlas::TextureAtlas(BakedAtlas const & baked, Texture2D::Config config)
+    : regions(baked.regions)
+{
+    config.maxLevels = config.maxLevels == 0 ? baked.page.levels : std::min(config.maxLevels, baked.page.levels);
+    config.wrap = { Texture2D::Wrap::Type::ClampToEdge };
+    page.emplace(baked.page, config);
+}
+
+void TextureAtlas::bind() const {
+    if (page) {
+        page->bind();
+    } else {
+        array->bind();
+    }
+}
+
+} // namespace core
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "atlas_packing.h"
+#include "image.h"
+#include "texture.h"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace core {
+
+// Several images sampled through one texture, so that they are bound once.
+// A single page is a Texture2D, images which need more become a Texture2DArray.
+// Regions clamp to their gutter, texture coordinates outside [0, 1] do not repeat.
+class TextureAtlas {
+public:
+    static constexpr size_t DEFAULT_PADDING = 8;
+    static constexpr size_t DEFAULT_MAX_SIZE = 4096;
+
+    // The wrap mode is always ClampToEdge and the mip chain is cut where the gutters run out.
+    TextureAtlas(
+        std::span<Image const * const> images,
+        Texture2D::Config config = {},
+        size_t padding = DEFAULT_PADDING,
+        size_t max_size = DEFAULT_MAX_SIZE);
+
+    // The baked page keeps its mip chain, which stops where the gutters run out.
+    explicit TextureAtlas(BakedAtlas const & baked, Texture2D::Config config = {});
+
+    void bind() const;
+
+    bool layered() const noexcept { return array.has_value(); }
+    size_t size() const noexcept { return regions.size(); }
+    AtlasRegion const & region(size_t i) const { return regions.at(i); }
+
+private:
+    std::vector<AtlasRegion> regions;
+    std::optional<Texture2D> page;
+    std::optional<Texture2DArray> array;
+};
+
+} // namespace core
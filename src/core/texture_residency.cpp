@@ -0,0 +1,173 @@
+#include "texture_residency.h"
+#include "texture.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace core {
+
+namespace internal {
+
+// Textures are only touched from the thread owning the context, so there is no locking.
+struct Residency {
+    void track(Texture2D & texture) {
+        texture.residency_slot = textures.size();
+        texture.last_use = frame;
+        textures.push_back(&texture);
+    }
+
+    void untrack(Texture2D & texture) {
+        assert(textures[texture.residency_slot] == &texture);
+        textures[texture.residency_slot] = textures.back();
+        textures[texture.residency_slot]->residency_slot = texture.residency_slot;
+        textures.pop_back();
+    }
+
+    void use(Texture2D const & bound) {
+        auto & texture = *textures[bound.residency_slot];
+        texture.last_use = frame;
+        if (texture.resident())
+            return;
+        texture.upload(texture.dropped_levels);
+        ++stats.reloads;
+    }
+
+    void pin(Texture2D const & bound) {
+        textures[bound.residency_slot]->pinned = true;
+    }
+
+    size_t residentBytes() const {
+        size_t bytes = 0;
+        for (auto const * texture : textures)
+            bytes += texture->memory.bytes();
+        return bytes;
+    }
+
+    void update() {
+        if (budget != 0)
+            enforceBudget();
+        ++frame;
+    }
+
+    void enforceBudget() {
+        size_t used = residentBytes();
+        if (used <= budget) {
+            restore(used);
+            return;
+        }
+
+        std::vector<Texture2D *> candidates;
+        for (auto * texture : textures) {
+            if (texture->resident() && !texture->pinned)
+                candidates.push_back(texture);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](auto const * a, auto const * b) { return a->last_use < b->last_use; });
+
+        // What was not drawn this frame goes first, it comes back when it is bound again.
+        for (auto * texture : candidates) {
+            if (used <= budget || texture->last_use == frame)
+                break;
+            used -= texture->memory.bytes();
+            texture->evict();
+            ++stats.evictions;
+        }
+
+        // Then the textures in use are blurred a level at a time, the least recently used first.
+        for (bool dropped = true; used > budget && dropped;) {
+            dropped = false;
+            for (auto * texture : candidates) {
+                if (used <= budget)
+                    break;
+                if (!texture->resident() || texture->dropped_levels == texture->maxDroppedLevels())
+                    continue;
+                used -= texture->memory.bytes();
+                texture->evict();
+                texture->upload(texture->dropped_levels + 1);
+                used += texture->memory.bytes();
+                ++stats.dropped_levels;
+                dropped = true;
+            }
+        }
+
+        if (used > budget && !warned) {
+            std::cerr << "Warning: textures in use take " << used << " bytes, over the residency budget of "
+                << budget << " bytes even at their lowest resolution" << std::endl;
+        }
+        warned = used > budget;
+    }
+
+    // A level comes back per frame when it fits, so sharpening never stalls a frame for long.
+    void restore(size_t used) {
+        Texture2D * sharpest = nullptr;
+        for (auto * texture : textures) {
+            if (texture->resident() && texture->dropped_levels > 0 && (!sharpest || texture->last_use > sharpest->last_use))
+                sharpest = texture;
+        }
+        if (!sharpest)
+            return;
+        size_t grown = sharpest->bytesWithout(sharpest->dropped_levels - 1);
+        if (used - sharpest->memory.bytes() + grown > budget)
+            return;
+        sharpest->evict();
+        sharpest->upload(sharpest->dropped_levels - 1);
+        ++stats.restored_levels;
+    }
+
+    std::vector<Texture2D *> textures;
+    size_t frame = 1;
+    size_t budget = texture_residency::DEFAULT_BUDGET;
+    bool warned = false;
+    TextureResidencyStats stats;
+};
+
+namespace {
+
+// Never destroyed: static renderers release their textures after it would be.
+Residency & residency() {
+    static Residency & instance = *new Residency;
+    return instance;
+}
+
+} // namespace
+
+void trackTexture(Texture2D & texture) { residency().track(texture); }
+void untrackTexture(Texture2D & texture) { residency().untrack(texture); }
+void useTexture(Texture2D const & texture) { residency().use(texture); }
+void pinTexture(Texture2D const & texture) { residency().pin(texture); }
+void updateTextureResidency() { residency().update(); }
+
+} // namespace internal
+
+namespace texture_residency {
+
+TextureResidencyStats stats() {
+    auto const & state = internal::residency();
+    auto current = state.stats;
+    current.textures = state.textures.size();
+    current.bytes = state.residentBytes();
+    return current;
+}
+
+void setBudget(size_t bytes) {
+    internal::residency().budget = bytes;
+}
+
+std::ostream & report(std::ostream & out) {
+    auto current = stats();
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(1)
+        << "Texture residency: " << current.textures << " textures in " << double(current.bytes) / 1024.0 << " KiB, "
+        << current.evictions << " evictions, " << current.reloads << " reloads, "
+        << current.dropped_levels << " levels dropped, " << current.restored_levels << " restored\n";
+    out.flags(flags);
+    out.precision(precision);
+    return out;
+}
+
+} // namespace texture_residency
+
+} // namespace core
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace core {
+
+class Texture2D;
+
+struct TextureResidencyStats {
+    // Textures which can be evicted and the memory they take now.
+    size_t textures = 0;
+    size_t bytes = 0;
+    size_t evictions = 0;
+    // Largest levels dropped to save memory, and put back once there was room again.
+    size_t dropped_levels = 0;
+    size_t restored_levels = 0;
+    // Evicted textures uploaded again when they were bound.
+    size_t reloads = 0;
+};
+
+// Keeps the textures uploaded from baked images within a memory budget. Their
+// pixels stay in the executable, so the GL texture can go at any time and come
+// back when it is bound again. Over the budget, textures which were not bound
+// during the last frame are evicted, least recently used first; if that is not
+// enough, the ones in use lose their largest mip levels. Textures with a
+// bindless handle and those uploaded from decoded images always stay.
+// Evicting or changing the levels gives a texture a new GL name which nothing
+// rebinds, so a baked texture has to be bound (e.g. by `UniformTexture::set`)
+// in every frame it is sampled in, not once when a lesson is prepared.
+namespace texture_residency {
+
+constexpr size_t DEFAULT_BUDGET = size_t(256) << 20;
+
+TextureResidencyStats stats();
+
+// 0 turns the budget off.
+void setBudget(size_t bytes);
+
+std::ostream & report(std::ostream & out);
+
+} // namespace texture_residency
+
+namespace internal {
+
+void trackTexture(Texture2D & texture);
+void untrackTexture(Texture2D & texture);
+// Reloads an evicted texture before it is bound.
+void useTexture(Texture2D const & texture);
+// The texture is never evicted again.
+void pinTexture(Texture2D const & texture);
+
+// Enforces the budget at the end of every frame.
+void updateTextureResidency();
+
+} // namespace internal
+
+} // namespace core
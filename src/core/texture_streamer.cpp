@@ -0,0 +1,187 @@
+#include "texture_streamer.h"
+#include "image_kernels.h"
+#include "thread_pool.h"
+#include "internal/features.h"
+#include "opengl.h"
+#include "exception.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+namespace core {
+
+namespace {
+
+constexpr size_t STAGING_REGIONS = 3;
+constexpr size_t UNPACK_ALIGNMENT = 4;
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+Image placeholderImage() {
+    Image image {
+        .width = 2,
+        .height = 2,
+        .format = Image::Format::RGBA,
+        .image = PixelStorage(2 * 2 * 4),
+    };
+    std::fill(image.image.begin(), image.image.end(), std::byte(128));
+    return image;
+}
+
+Texture2D::Config placeholderConfig() {
+    Texture2D::Config config;
+    config.minFilter = Texture2D::Filter::Nearest;
+    config.magFilter = Texture2D::Filter::Nearest;
+    config.mipmaps = Texture2D::Mipmaps::None;
+    config.anisotropy = 1.0f;
+    return config;
+}
+
+} // namespace
+
+void StreamedTexture::bind() const {
+    if (sampleable()) {
+        texture->bind();
+    } else {
+        placeholder->bind();
+    }
+}
+
+TextureStreamer::TextureStreamer(size_t frame_budget)
+    : frame_budget(frame_budget)
+    , placeholder(placeholderImage(), placeholderConfig())
+{
+    REQUIRE(frame_budget > 0, "Texture streamer needs a budget to upload anything");
+    // Without persistently mapped buffers the pixels are uploaded straight from the decoded images.
+    if (internal::hasBufferStorage())
+        staging.emplace(alignUp(frame_budget, UNPACK_ALIGNMENT), STAGING_REGIONS);
+}
+
+TextureStreamer::~TextureStreamer() = default;
+
+StreamedTexture const & TextureStreamer::request(ImgResources resource, Texture2D::Config config) {
+    auto & texture = textures.emplace_back(new StreamedTexture(placeholder, config));
+    {
+        std::lock_guard lock(decoded->mutex);
+        ++decoded->pending;
+    }
+
+    // The task never touches the streamer, it may be destroyed before the image is decoded.
+    bool mipmaps = config.mipmaps != Texture2D::Mipmaps::None;
+    workerPool().submit([decoded = decoded, target = texture.get(), resource, mipmaps] {
+        Upload upload { .target = target, .base = {}, .mips = {}, .error = {} };
+        try {
+            upload.base = loadResource(resource);
+            if (mipmaps) {
+                size_t levels = mipLevelsOf(upload.base->width, upload.base->height);
+                upload.mips.reserve(levels - 1);
+                Image const * previous = upload.base.get();
+                for (size_t level = 1; level < levels; ++level)
+                    previous = &upload.mips.emplace_back(downsampled(*previous, true));
+            }
+        } catch (...) {
+            upload.error = std::current_exception();
+        }
+
+        std::lock_guard lock(decoded->mutex);
+        decoded->uploads.push_back(std::move(upload));
+        --decoded->pending;
+    });
+    return *texture;
+}
+
+bool TextureStreamer::idle() const {
+    std::lock_guard lock(decoded->mutex);
+    return decoded->pending == 0 && decoded->uploads.empty() && uploads.empty();
+}
+
+void TextureStreamer::update() {
+    {
+        std::lock_guard lock(decoded->mutex);
+        std::move(decoded->uploads.begin(), decoded->uploads.end(), std::back_inserter(uploads));
+        decoded->uploads.clear();
+    }
+    if (uploads.empty())
+        return;
+
+    if (staging)
+        staging->beginFrame();
+    size_t budget = frame_budget;
+    while (!uploads.empty()) {
+        if (uploads.front().error) {
+            auto error = uploads.front().error;
+            uploads.pop_front();
+            if (staging)
+                staging->endFrame();
+            std::rethrow_exception(error);
+        }
+        if (!upload(uploads.front(), budget))
+            break;
+        uploads.pop_front();
+    }
+    if (staging)
+        staging->endFrame();
+}
+
+bool TextureStreamer::upload(Upload & upload, size_t & budget) {
+    auto & target = *upload.target;
+    if (!target.texture) {
+        auto const & base = *upload.base;
+        target.texture.emplace(base.width, base.height, base.format, target.config);
+        upload.level = target.texture->levels() - 1;
+        // Levels without pixels are never sampled.
+        target.texture->setBaseLevel(upload.level);
+    }
+
+    for (;;) {
+        auto const & image = upload.level == 0 ? *upload.base : upload.mips[upload.level - 1];
+        // RGB rows are expanded on their way, RGBA is what crosses the bus.
+        auto format = image.format == Image::Format::RGB ? Image::Format::RGBA : image.format;
+        size_t row_bytes = image.width * bytesPerPixelOf(format);
+        size_t rows = std::min(image.height - upload.row, budget / row_bytes);
+        if (rows == 0) {
+            // A row bigger than the whole budget still goes, alone in its frame.
+            if (budget < frame_budget)
+                return false;
+            rows = 1;
+        }
+
+        size_t bytes = rows * row_bytes;
+        // Unpack offsets are 4 aligned, the padding comes out of the frame too.
+        size_t charged = alignUp(bytes, UNPACK_ALIGNMENT);
+        size_t source_row_bytes = image.width * bytesPerPixelOf(image.format);
+        std::span<std::byte const> pixels(image.image.data() + upload.row * source_row_bytes, rows * source_row_bytes);
+        if (staging && charged <= budget) {
+            auto allocation = staging->allocate(bytes, UNPACK_ALIGNMENT);
+            if (image.format == Image::Format::RGB) {
+                kernels::expandRgbToRgba(pixels, { allocation.data, bytes });
+            } else {
+                std::memcpy(allocation.data, pixels.data(), bytes);
+            }
+            staging->bind(StreamTarget::PixelUnpack);
+            target.texture->updateFromBuffer(upload.level, upload.row, rows, format, allocation.offset);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        } else {
+            target.texture->update(upload.level, upload.row, rows, image.format, pixels.data());
+        }
+        budget -= std::min(budget, charged);
+
+        upload.row += rows;
+        if (upload.row == image.height) {
+            target.texture->setBaseLevel(upload.level);
+            ++target.uploaded_levels;
+            upload.row = 0;
+            if (upload.level == 0)
+                return true;
+            --upload.level;
+        }
+        if (budget == 0)
+            return false;
+    }
+}
+
+} // namespace core
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "image.h"
+#include "image_resource_loader.h"
+#include "stream_ring_buffer.h"
+#include "texture.h"
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace core {
+
+class TextureStreamer;
+
+// A texture which is still being streamed in binds a placeholder instead.
+class StreamedTexture {
+public:
+    void bind() const;
+
+    // Some levels are uploaded, it is sampled at a lower resolution until all of them are.
+    bool sampleable() const noexcept { return texture && uploaded_levels > 0; }
+    bool resident() const noexcept { return texture && uploaded_levels == texture->levels(); }
+
+private:
+    friend class TextureStreamer;
+
+    StreamedTexture(Texture2D const & placeholder, Texture2D::Config config)
+        : placeholder(&placeholder)
+        , config(config)
+    {}
+
+    Texture2D const * placeholder;
+    Texture2D::Config config;
+    std::optional<Texture2D> texture;
+    size_t uploaded_levels = 0;
+};
+
+// Loads textures without stalling frames. Images are decoded and mipmapped on
+// the worker pool, `update` then uploads them through a ring of pixel unpack
+// buffers, at most `frame_budget` bytes per frame. The smallest levels go
+// first, so textures sharpen as they stream in.
+class TextureStreamer {
+public:
+    static constexpr size_t DEFAULT_FRAME_BUDGET = size_t(4) << 20;
+
+    explicit TextureStreamer(size_t frame_budget = DEFAULT_FRAME_BUDGET);
+    ~TextureStreamer();
+
+    TextureStreamer(TextureStreamer const &) = delete;
+    TextureStreamer & operator=(TextureStreamer const &) = delete;
+
+    // The texture lives as long as the streamer. Mip levels are always
+    // computed on the workers, `Mipmaps::Generate` is treated as `GammaCorrect`.
+    StreamedTexture const & request(ImgResources resource, Texture2D::Config config = {});
+
+    // Uploads whatever fits the budget, once per frame before textures are bound.
+    // Rethrows what decoding a requested image threw.
+    void update();
+
+    // Nothing is waiting to be decoded or uploaded.
+    bool idle() const;
+
+private:
+    struct Upload {
+        StreamedTexture * target;
+        SharedImage base;
+        // Level i + 1 of the chain.
+        std::vector<Image> mips;
+        std::exception_ptr error;
+        size_t level = 0;
+        size_t row = 0;
+    };
+
+    // Shared with the decoding tasks, which may finish after the streamer is gone.
+    struct Decoded {
+        std::mutex mutex;
+        std::deque<Upload> uploads;
+        size_t pending = 0;
+    };
+
+    // Returns false once the frame is out of budget.
+    bool upload(Upload & upload, size_t & budget);
+
+    size_t frame_budget;
+    Texture2D placeholder;
+    std::optional<StreamRingBuffer> staging;
+    std::vector<std::unique_ptr<StreamedTexture>> textures;
+    // Owned by the render thread.
+    std::deque<Upload> uploads;
+    std::shared_ptr<Decoded> decoded = std::make_shared<Decoded>();
+};
+
+} // namespace core
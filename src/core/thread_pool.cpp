@@ -0,0 +1,44 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace core {
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    for (size_t i = 0; i < std::max<size_t>(thread_count, 1); ++i)
+        threads.emplace_back([this](std::stop_token stop) { run(stop); });
+}
+
+// Stops the threads once they finish their current tasks, queued ones are dropped.
+ThreadPool::~ThreadPool() = default;
+
+void ThreadPool::push(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::run(std::stop_token stop) {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex);
+            if (!wake.wait(lock, stop, [&] { return !tasks.empty(); }))
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+ThreadPool & workerPool() {
+    // Never destroyed: static renderers may still be waiting for their tasks when it would be.
+    static ThreadPool & instance = *new ThreadPool(std::thread::hardware_concurrency());
+    return instance;
+}
+
+} // namespace core
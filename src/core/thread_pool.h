@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace core {
+
+// A fixed set of worker threads running queued tasks in order of submission.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool & operator=(ThreadPool const &) = delete;
+
+    // Exceptions thrown by the task are rethrown by the future.
+    template<class Task>
+    auto submit(Task task) -> std::future<std::invoke_result_t<Task &>> {
+        using Result = std::invoke_result_t<Task &>;
+        // std::function needs a copyable callable, packaged tasks are move-only.
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        auto future = packaged->get_future();
+        push([packaged] { (*packaged)(); });
+        return future;
+    }
+
+    size_t size() const noexcept { return threads.size(); }
+
+private:
+    void push(std::function<void()> task);
+    void run(std::stop_token stop);
+
+    std::mutex mutex;
+    std::condition_variable_any wake;
+    std::deque<std::function<void()>> tasks;
+    // Last, so that the threads stop before the queue is destroyed.
+    std::vector<std::jthread> threads;
+};
+
+// One thread per core for background work such as decoding images.
+ThreadPool & workerPool();
+
+} // namespace core
@@ -0,0 +1,34 @@
+#include "vertex_packing.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <bit>
+
+namespace core {
+
+uint16_t packHalf(float value) {
+    return glm::packHalf1x16(value);
+}
+
+uint8_t packUnorm8(float value) {
+    return glm::packUnorm1x8(value);
+}
+
+uint16_t packUnorm16(float value) {
+    return glm::packUnorm1x16(value);
+}
+
+int8_t packSnorm8(float value) {
+    return std::bit_cast<int8_t>(glm::packSnorm1x8(value));
+}
+
+int16_t packSnorm16(float value) {
+    return std::bit_cast<int16_t>(glm::packSnorm1x16(value));
+}
+
+uint32_t packSnorm2_10_10_10(glm::vec4 value) {
+    return glm::packSnorm3x10_1x2(value);
+}
+
+} // namespace core
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glm/vec4.hpp>
+
+#include <cstdint>
+
+namespace core {
+
+// CPU side quantisation of vertex attributes, see `Attribute::Type` for the matching GPU formats.
+
+// IEEE 754 half precision, `Attribute::Type::HalfFloat`.
+uint16_t packHalf(float value);
+
+// [0, 1] -> `UnsignedByte`/`UnsignedShort` with `normalize = true`.
+uint8_t packUnorm8(float value);
+uint16_t packUnorm16(float value);
+
+// [-1, 1] -> `Byte`/`Short` with `normalize = true`.
+int8_t packSnorm8(float value);
+int16_t packSnorm16(float value);
+
+// [-1, 1]^4 -> `Int2_10_10_10_Rev` with `normalize = true`. x ends up in the lowest bits.
+uint32_t packSnorm2_10_10_10(glm::vec4 value);
+
+} // namespace core
@@ -2,6 +2,10 @@
 
 #include "opengl.h"
 #include "exception.h"
+#include "frame_arena.h"
+#include "gpu_memory.h"
+#include "texture_residency.h"
+#include "internal/gl_objects.h"
 
 #include <GLFW/glfw3.h>
 
@@ -100,6 +104,7 @@ Window::Window(size_t width, size_t height, GLFWwindow * window)
 {}
 
 Window::~Window() {
+    internal::flushDeletedObjects();
     if (window) {
         glfwSetWindowShouldClose(window, GL_TRUE);
         glfwDestroyWindow(window);
@@ -122,10 +127,12 @@ Window::ExitReason Window::render(Renderer & renderer) {
     prev_mouse_pos.reset();
 
     PointerGuard _(executing_renderer, &renderer);
+    gpu_memory::ScopedTag tag(renderer.name());
     renderer.prepare();
 
     float prev_render_time = float(glfwGetTime());
     while (!exit_reason) {
+        frameArena().reset();
         glfwPollEvents();
 
         float current_render_time = float(glfwGetTime());
@@ -134,6 +141,8 @@ Window::ExitReason Window::render(Renderer & renderer) {
         prev_render_time = current_render_time;
 
         glfwSwapBuffers(window);
+        internal::updateTextureResidency();
+        internal::collectDeletedObjects();
     }
 
     return *exit_reason;
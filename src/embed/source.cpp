@@ -1,5 +1,18 @@
+#include <core/atlas_packing.h>
+#include <core/block_compression.h>
+#include <core/image.h>
+
+#include <SOIL/SOIL.h>
+
+#include <array>
+#include <bit>
+#include <charconv>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 #include <filesystem>
@@ -15,30 +28,400 @@ std::vector<uint8_t> readFile(fs::path const& file_name) {
     return {std::istreambuf_iterator<char>(input), {}};
 }
 
-void write(std::vector<uint8_t> const& resource, fs::path const& output_file) {
+std::ofstream openOutput(fs::path const& output_file) {
     std::ofstream out(output_file, std::ios::out);
     if (!out.is_open()) {
         std::cerr << "Cannot open output file: '" << output_file << "'" << std::endl;
         throw 1;
     }
+    return out;
+}
+
+void writeFile(fs::path const& output_file, std::span<uint8_t const> bytes) {
+    std::ofstream out(output_file, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Cannot open output file: '" << output_file << "'" << std::endl;
+        throw 1;
+    }
+    out.write(reinterpret_cast<char const*>(bytes.data()), std::streamsize(bytes.size()));
+}
+
+// How the bytes reach the compiler. A string literal is parsed far faster than
+// a list of numbers; #embed and .incbin leave the bytes out of the source.
+enum class OutputMode { String, Embed, Incbin };
+
+std::optional<OutputMode> parseOutputMode(std::string_view name) {
+    if (name == "string") return OutputMode::String;
+    if (name == "embed") return OutputMode::Embed;
+    if (name == "incbin") return OutputMode::Incbin;
+    return std::nullopt;
+}
+
+std::ofstream openHeader(fs::path const& output_file, OutputMode mode, std::string_view action, fs::path const& file_path) {
+    auto out = openOutput(output_file);
+    out << "#pragma once\n";
+    // #embed is an extension in C++ and string literals of several hundred KiB
+    // go past the length compilers have to support (-Woverlength-strings), which
+    // -pedantic-errors would reject anywhere else.
+    if (mode != OutputMode::Incbin)
+        out << "#pragma GCC system_header\n";
+    out << "// " << action << " by embed from " << file_path.filename().string() << ", do not edit.\n";
+    return out;
+}
+
+// Pieces of string literal with printable characters as they are and the rest
+// as octal escapes. Those always take three digits, so a digit after one is
+// never read into it.
+void writeString(std::ostream& out, std::span<uint8_t const> bytes) {
+    constexpr size_t PIECE_SIZE = 4096;
+    std::string text;
+    text.reserve(bytes.size() * 4 + bytes.size() / PIECE_SIZE * 3 + 2);
+    text += '"';
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        if (i != 0 && i % PIECE_SIZE == 0)
+            text += "\"\n\"";
+        auto byte = bytes[i];
+        if (byte >= 0x20 && byte < 0x7F && byte != '"' && byte != '\\') {
+            text += char(byte);
+        } else {
+            text += '\\';
+            text += char('0' + (byte >> 6));
+            text += char('0' + ((byte >> 3) & 7));
+            text += char('0' + (byte & 7));
+        }
+    }
+    text += '"';
+    out << text;
+}
+
+// Defines `symbol`, 16-byte aligned, and `symbol_size`. #embed and .incbin take
+// the bytes from `data_file`, which has to hold them already; the .incbin is
+// assembled from `asm_file`.
+void writeArray(std::ostream& out, OutputMode mode, std::string const& symbol, std::span<uint8_t const> bytes, fs::path const& data_file, fs::path const& asm_file) {
+    out << "inline constexpr size_t " << symbol << "_size = " << bytes.size() << ";\n";
+    // An empty #embed would leave a zero-sized array.
+    if (mode == OutputMode::Embed && bytes.empty())
+        mode = OutputMode::String;
+    switch (mode) {
+    case OutputMode::String:
+        // The array holds a terminating NUL past the bytes.
+        out << "alignas(16) inline constexpr unsigned char " << symbol << "[] =\n";
+        writeString(out, bytes);
+        out << ";\n";
+        break;
+    case OutputMode::Embed:
+        out << "alignas(16) inline constexpr unsigned char " << symbol << "[] = {\n"
+            << "#embed \"" << fs::absolute(data_file).generic_string() << "\"\n"
+            << "};\n";
+        break;
+    case OutputMode::Incbin: {
+        out << "extern \"C\" unsigned char const " << symbol << "[];\n";
+        auto as = openOutput(asm_file);
+        as << "/* Embedded by embed from " << data_file.filename().string() << ", do not edit. */\n"
+           << "#if defined(__APPLE__)\n"
+           << "    .section __TEXT,__const\n"
+           << "    .balign 16\n"
+           << "    .globl _" << symbol << "\n"
+           << "_" << symbol << ":\n"
+           << "#else\n"
+           << "    .section .rodata\n"
+           << "    .balign 16\n"
+           << "    .globl " << symbol << "\n"
+           << symbol << ":\n"
+           << "#endif\n"
+           << "    .incbin \"" << fs::absolute(data_file).generic_string() << "\"\n"
+           << "#if defined(__ELF__)\n"
+           << "    .section .note.GNU-stack,\"\",%progbits\n"
+           << "#endif\n";
+        break;
+    }
+    }
+}
+
+// The file as it is, for the runtime to decode.
+void embed(fs::path const& file_path, OutputMode mode, fs::path const& output_dir) {
+    auto const content = readFile(file_path);
+    auto const name = file_path.stem().string();
+    auto out = openHeader(output_dir / (name + ".h"), mode, "Embedded", file_path);
+    writeArray(out, mode, name + "_data", content, file_path, output_dir / (name + ".S"));
+}
+
+core::Image decode(fs::path const& file_name) {
+    auto const content = readFile(file_name);
+    int w, h, channels;
+    auto* data = SOIL_load_image_from_memory(content.data(), (int)content.size(), &w, &h, &channels, SOIL_LOAD_AUTO);
+    if (!data || channels < 1 || channels > 4) {
+        std::cerr << "Cannot decode image: '" << file_name << "'" << std::endl;
+        throw 1;
+    }
+
+    return {
+        .width = static_cast<size_t>(w),
+        .height = static_cast<size_t>(h),
+        .format = std::array { core::Image::Format::R8, core::Image::Format::RG8, core::Image::Format::RGB, core::Image::Format::RGBA }[size_t(channels - 1)],
+        .image = core::PixelStorage::adopt(reinterpret_cast<std::byte*>(data), size_t(w) * size_t(h) * size_t(channels), [](std::byte* pixels) {
+            SOIL_free_image_data(reinterpret_cast<unsigned char*>(pixels));
+        }),
+    };
+}
+
+// Stores the first channel of `source` as the alpha of `image`.
+core::Image packAlpha(core::Image const& color, core::Image const& source) {
+    if (source.width != color.width || source.height != color.height) {
+        std::cerr << "Packed images should have the same size" << std::endl;
+        throw 1;
+    }
+
+    auto image = color.format == core::Image::Format::RGBA ? color : core::converted(color, core::Image::Format::RGB);
+    size_t channels = core::channelsOf(image.format);
+    size_t source_channels = core::channelsOf(source.format);
+    core::Image result {
+        .width = image.width,
+        .height = image.height,
+        .format = core::Image::Format::RGBA,
+        .image = core::PixelStorage(image.width * image.height * 4),
+    };
+    for (size_t i = 0; i < image.width * image.height; ++i) {
+        for (size_t c = 0; c < 3; ++c)
+            result.image[i * 4 + c] = image.image[i * channels + c];
+        result.image[i * 4 + 3] = source.image[i * source_channels];
+    }
+    return result;
+}
+
+std::optional<core::Image::Format> parseCompression(std::string_view name) {
+    if (name == "bc1") return core::Image::Format::BC1;
+    if (name == "bc3") return core::Image::Format::BC3;
+    if (name == "bc4") return core::Image::Format::BC4;
+    if (name == "bc7") return core::Image::Format::BC7;
+    return std::nullopt;
+}
 
-    if (!resource.empty())
-        out << (int)resource[0];
-    for (size_t i = 1; i < resource.size(); ++i)
-        out << ',' << (int)resource[i];
+std::optional<core::Image::Format> parseFormat(std::string_view name) {
+    if (name == "r8") return core::Image::Format::R8;
+    if (name == "rg8") return core::Image::Format::RG8;
+    if (name == "r16") return core::Image::Format::R16;
+    if (name == "rgba16") return core::Image::Format::RGBA16;
+    if (name == "r16f") return core::Image::Format::R16F;
+    if (name == "rgba16f") return core::Image::Format::RGBA16F;
+    if (name == "r32f") return core::Image::Format::R32F;
+    if (name == "rgba32f") return core::Image::Format::RGBA32F;
+    return std::nullopt;
+}
+
+std::optional<core::MipFilter> parseFilter(std::string_view name) {
+    if (name == "box") return core::MipFilter::Box;
+    if (name == "kaiser") return core::MipFilter::Kaiser;
+    return std::nullopt;
+}
+
+char const* formatName(core::Image::Format format) {
+    switch (format) {
+    case core::Image::Format::RGB: return "RGB";
+    case core::Image::Format::RGBA: return "RGBA";
+    case core::Image::Format::BC1: return "BC1";
+    case core::Image::Format::BC3: return "BC3";
+    case core::Image::Format::BC4: return "BC4";
+    case core::Image::Format::BC7: return "BC7";
+    case core::Image::Format::R8: return "R8";
+    case core::Image::Format::RG8: return "RG8";
+    case core::Image::Format::R16: return "R16";
+    case core::Image::Format::RGBA16: return "RGBA16";
+    case core::Image::Format::R16F: return "R16F";
+    case core::Image::Format::RGBA16F: return "RGBA16F";
+    case core::Image::Format::R32F: return "R32F";
+    case core::Image::Format::RGBA32F: return "RGBA32F";
+    }
+}
+
+struct BakeOptions {
+    // Average mips as they are instead of as sRGB colors, for data such as specular maps.
+    bool linear = false;
+    bool mipmaps = true;
+    std::optional<fs::path> alpha_from;
+    // Uncompressed levels are stored in this format instead of the decoded one.
+    std::optional<core::Image::Format> format;
+    core::MipFilter filter = core::MipFilter::Box;
+    // Every level is encoded into blocks after the mip chain is built.
+    std::optional<core::Image::Format> compression;
+};
+
+// Writes the levels, encoded into blocks if asked for, as `<name>.baked.h`.
+std::ofstream writeBaked(std::string const& name, std::vector<core::Image>& levels, BakeOptions const& options, OutputMode mode, fs::path const& output_dir, fs::path const& source) {
+    if (options.compression) {
+        for (auto& level : levels)
+            level = core::compressed(level, *options.compression);
+    }
+
+    std::vector<uint8_t> pixels;
+    for (auto const& level : levels) {
+        auto const* bytes = reinterpret_cast<uint8_t const*>(level.image.data());
+        pixels.insert(pixels.end(), bytes, bytes + level.image.size());
+    }
+
+    auto const data_file = output_dir / (name + ".baked.bin");
+    if (mode != OutputMode::String)
+        writeFile(data_file, pixels);
+    auto out = openHeader(output_dir / (name + ".baked.h"), mode, "Baked", source);
+    out << "inline constexpr size_t " << name << "_width = " << levels[0].width << ";\n"
+        << "inline constexpr size_t " << name << "_height = " << levels[0].height << ";\n"
+        << "inline constexpr core::Image::Format " << name << "_format = core::Image::Format::" << formatName(levels[0].format) << ";\n"
+        << "inline constexpr size_t " << name << "_levels = " << levels.size() << ";\n";
+    writeArray(out, mode, name + "_pixels", pixels, data_file, output_dir / (name + ".baked.S"));
+    return out;
+}
+
+// Decodes the image and writes it with its whole mip chain, so that the
+// runtime only has to hand the pixels over to the texture.
+void bake(fs::path const& file_path, BakeOptions const& options, OutputMode mode, fs::path const& output_dir) {
+    auto image = decode(file_path);
+    if (options.alpha_from)
+        image = packAlpha(image, decode(*options.alpha_from));
+    if (options.format)
+        image = core::converted(image, *options.format);
+
+    std::vector<core::Image> levels;
+    levels.push_back(std::move(image));
+    size_t level_count = options.mipmaps ? core::mipLevelsOf(levels[0].width, levels[0].height) : 1;
+    while (levels.size() < level_count)
+        levels.push_back(core::downsampled(levels.back(), !options.linear, options.filter));
+    writeBaked(file_path.stem().string(), levels, options, mode, output_dir, file_path);
+}
+
+// Pages of core::TextureAtlas, the runtime cannot load bigger ones.
+constexpr size_t ATLAS_MAX_SIZE = 4096;
+
+// Packs the images into one page, see core::layoutAtlas, and writes it the way
+// `bake` writes an image, followed by `<name>_regions`: the top-left texel, the
+// width and the height of every image. Each level of the page is made of the
+// images' own mips, so the chain stops at level log2(padding), the last one
+// where the images start on whole texels.
+void bakeAtlas(std::string const& name, std::span<fs::path const> files, size_t padding, BakeOptions const& options, OutputMode mode, fs::path const& output_dir) {
+    std::vector<std::vector<core::Image>> chains;
+    for (auto const& file : files) {
+        auto& chain = chains.emplace_back();
+        chain.push_back(decode(file));
+        if (options.format)
+            chain[0] = core::converted(chain[0], *options.format);
+    }
+
+    std::vector<core::Image const*> images;
+    for (auto const& chain : chains)
+        images.push_back(&chain[0]);
+    auto layout = core::layoutAtlas(images, padding, ATLAS_MAX_SIZE);
+    if (layout.pages != 1) {
+        std::cerr << "Baked atlas '" << name << "' does not fit into one page" << std::endl;
+        throw 1;
+    }
+
+    size_t level_count = options.mipmaps
+        ? std::min(size_t(std::countr_zero(padding)) + 1, core::mipLevelsOf(layout.page_width, layout.page_height))
+        : 1;
+    std::vector<core::Image> levels;
+    for (size_t level = 0; level < level_count; ++level) {
+        for (size_t i = 0; i < chains.size(); ++i) {
+            if (level > 0)
+                chains[i].push_back(core::downsampled(chains[i].back(), !options.linear, options.filter));
+            images[i] = &chains[i].back();
+        }
+        levels.push_back(std::move(core::renderAtlas(layout, images, level).front()));
+    }
+
+    auto out = writeBaked(name, levels, options, mode, output_dir, files.front());
+    out << "inline constexpr size_t " << name << "_regions[][4] = {\n";
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto const& placement = layout.placements[i];
+        out << "    { " << placement.x + padding << ", " << placement.y + padding << ", "
+            << chains[i][0].width << ", " << chains[i][0].height << " }, // " << files[i].filename().string() << "\n";
+    }
+    out << "};\n";
+}
+
+void usage(char const* prog_name) {
+    std::cerr << "Usage: " << prog_name << " [--output string|embed|incbin] <binary_file> <output_dir>\n"
+              << "       " << prog_name << " [--output string|embed|incbin] --bake [--linear] [--no-mipmaps] [--filter box|kaiser] [--alpha-from <image>] [--format r8|rg8|r16|rgba16|r16f|rgba16f|r32f|rgba32f] [--compress bc1|bc3|bc4|bc7] <image> <output_dir>\n"
+              << "       " << prog_name << " [--output string|embed|incbin] --atlas <name> [--padding <power of two>] [bake options but --alpha-from] <image>... <output_dir>" << std::endl;
+}
+
+std::optional<size_t> parsePadding(std::string_view text) {
+    size_t padding = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), padding);
+    if (error != std::errc() || end != text.data() + text.size() || !std::has_single_bit(padding))
+        return std::nullopt;
+    return padding;
 }
 
 int main(int argc, char const* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <binary_file> <output_dir>" << std::endl;
+    int arg = 1;
+    auto mode = OutputMode::String;
+    if (argc > 2 && std::string_view(argv[1]) == "--output" && parseOutputMode(argv[2])) {
+        mode = *parseOutputMode(argv[2]);
+        arg = 3;
+    }
+    if (argc - arg < 2) {
+        usage(argv[0]);
         return 1;
     }
 
-    const auto file_path = fs::path(argv[1]);
-    const auto file_content = readFile(file_path);
+    try {
+        std::optional<std::string> atlas;
+        if (std::string_view(argv[arg]) == "--atlas" && argc - arg > 3) {
+            atlas = argv[arg + 1];
+            arg += 2;
+        } else if (std::string_view(argv[arg]) == "--bake") {
+            ++arg;
+        } else {
+            if (argc - arg != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+            embed(fs::path(argv[arg]), mode, fs::path(argv[arg + 1]));
+            return 0;
+        }
 
-    const auto output_file = fs::path(argv[2]) / file_path.stem().concat(".h");
-    write(file_content, output_file);
+        BakeOptions options;
+        // The default of core::TextureAtlas.
+        size_t padding = 8;
+        for (; arg < argc - 2 && std::string_view(argv[arg]).starts_with("--"); ++arg) {
+            std::string_view option = argv[arg];
+            if (option == "--linear") {
+                options.linear = true;
+            } else if (option == "--no-mipmaps") {
+                options.mipmaps = false;
+            } else if (option == "--alpha-from" && !atlas && arg + 1 < argc - 2) {
+                options.alpha_from = fs::path(argv[++arg]);
+            } else if (option == "--padding" && atlas && arg + 1 < argc - 2 && parsePadding(argv[arg + 1])) {
+                padding = *parsePadding(argv[++arg]);
+            } else if (option == "--filter" && arg + 1 < argc - 2 && parseFilter(argv[arg + 1])) {
+                options.filter = *parseFilter(argv[++arg]);
+            } else if (option == "--format" && arg + 1 < argc - 2 && parseFormat(argv[arg + 1])) {
+                options.format = parseFormat(argv[++arg]);
+            } else if (option == "--compress" && arg + 1 < argc - 2 && parseCompression(argv[arg + 1])) {
+                options.compression = parseCompression(argv[++arg]);
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+
+        std::vector<fs::path> images(argv + arg, argv + argc - 1);
+        fs::path output_dir(argv[argc - 1]);
+        if (images.empty() || (!atlas && images.size() != 1)) {
+            usage(argv[0]);
+            return 1;
+        }
+
+        if (atlas) {
+            bakeAtlas(*atlas, images, padding, options, mode, output_dir);
+        } else {
+            bake(images.front(), options, mode, output_dir);
+        }
+    } catch (int code) {
+        return code;
+    } catch (char const* message) {
+        std::cerr << message << std::endl;
+        return 1;
+    }
 
     return 0;
 }
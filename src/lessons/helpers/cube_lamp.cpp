@@ -52,8 +52,8 @@ CubeLamp::CubeLamp(glm::vec3 light_pos)
 
 CubeLamp::CubeLamp(core::PointLight light)
     : light(std::move(light))
-    , vbo(prim::CUBE.data(), prim::CUBE.size(), sizeof(prim::CUBE[0]), core::BufferUsage::StaticDraw)
-    , drawer(program, vbo)
+    , cube(prim::indexedCube())
+    , drawer(program, cube.vertices(), cube.indices())
 {}
 
 void CubeLamp::draw(glm::mat4 const & viewProj) {
@@ -63,7 +63,7 @@ void CubeLamp::draw(glm::mat4 const & viewProj) {
     drawer.program().color.set(light.components.diffuse);
 
     drawer.program().viewProjection.set(viewProj);
-    drawer.draw(core::PrimitiveType::Triangles);
+    drawer.draw(core::PrimitiveType::Triangles, cube.range());
 }
 
 core::SimpleLight CubeLamp::simpleLight() const {
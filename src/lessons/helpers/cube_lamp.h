@@ -1,7 +1,7 @@
-#include "../../core/vertex_buffer.h"
 #include "../../core/drawer.h"
 #include "../../core/light.h"
 #include "core/program.h"
+#include "shared_meshes.h"
 
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
@@ -27,7 +27,7 @@ public:
     core::PointLight light;
 private:
     Program program;
-    core::VertexBuffer vbo;
+    prim::SharedMesh const & cube;
     core::Drawer<Program> drawer;
 };
 
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <core/mesh.h>
+#include <core/vertex_packing.h>
+
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 #include <array>
+#include <cstdint>
 
 namespace prim {
 
@@ -160,23 +164,64 @@ constexpr CubeNormals CUBE_NORMALS = {{
 struct TexturedCubeVertex {
     glm::vec3 pos;
     glm::vec2 texCoord;
+
+    bool operator==(TexturedCubeVertex const &) const = default;
 };
 
 struct CubeVertexWithNormal {
     glm::vec3 pos;
     glm::vec3 normal;
+
+    bool operator==(CubeVertexWithNormal const &) const = default;
 };
 
 struct TexturedCubeVertexWithNormal {
     glm::vec3 pos;
     glm::vec2 texCoord;
     glm::vec3 normal;
+
+    bool operator==(TexturedCubeVertexWithNormal const &) const = default;
 };
 
 constexpr auto TEXTURED_CUBE = internal::zip<TexturedCubeVertex>(CUBE, CUBE_TEX_COORDS);
 constexpr auto CUBE_WITH_NORMALS = internal::zip<CubeVertexWithNormal>(CUBE, CUBE_NORMALS);
 constexpr auto TEXTURED_CUBE_WITH_NORMALS = internal::zip<TexturedCubeVertexWithNormal>(CUBE, CUBE_TEX_COORDS, CUBE_NORMALS);
 
+// Welded versions of the cubes above: 8 or 24 unique vertices plus 36 16-bit indices instead of 36 vertices.
+constexpr auto INDEXED_CUBE = core::weld<CUBE>();
+constexpr auto INDEXED_TEXTURED_CUBE = core::weld<TEXTURED_CUBE>();
+constexpr auto INDEXED_CUBE_WITH_NORMALS = core::weld<CUBE_WITH_NORMALS>();
+constexpr auto INDEXED_TEXTURED_CUBE_WITH_NORMALS = core::weld<TEXTURED_CUBE_WITH_NORMALS>();
+
+static_assert(INDEXED_CUBE.vertices.size() == 8);
+static_assert(INDEXED_CUBE_WITH_NORMALS.vertices.size() == 24);
+static_assert(INDEXED_TEXTURED_CUBE_WITH_NORMALS.vertices.size() == 24);
+
+// 16 bytes instead of 32: half float position, unorm16 texture coordinates and a 2_10_10_10 normal.
+struct PackedTexturedCubeVertexWithNormal {
+    std::array<uint16_t, 3> pos;
+    std::array<uint16_t, 2> texCoord;
+    uint32_t normal;
+};
+
+static_assert(sizeof(PackedTexturedCubeVertexWithNormal) == 16);
+
+inline PackedTexturedCubeVertexWithNormal pack(TexturedCubeVertexWithNormal const & vertex) {
+    return {
+        .pos = {core::packHalf(vertex.pos.x), core::packHalf(vertex.pos.y), core::packHalf(vertex.pos.z)},
+        .texCoord = {core::packUnorm16(vertex.texCoord.x), core::packUnorm16(vertex.texCoord.y)},
+        .normal = core::packSnorm2_10_10_10(glm::vec4(vertex.normal, 0.0f)),
+    };
+}
+
+template<class Vertex, size_t N>
+auto pack(std::array<Vertex, N> const & vertices) {
+    std::array<decltype(pack(vertices[0])), N> packed;
+    for (size_t i = 0; i < N; ++i)
+        packed[i] = pack(vertices[i]);
+    return packed;
+}
+
 constexpr std::array TEN_CUBE_POSITIONS = {
     glm::vec3( 0.0f,  0.0f,  0.0f),
     glm::vec3( 2.0f,  5.0f, -15.0f),
@@ -0,0 +1,78 @@
+#include "shared_meshes.h"
+#include "primitives.h"
+
+#include <core/mesh_optimizer.h>
+
+#include <span>
+#include <string_view>
+
+namespace prim {
+
+namespace {
+
+// Lessons draw a handful of small meshes, one page holds all of them.
+constexpr size_t VERTICES_PER_PAGE = 1 << 10;
+constexpr size_t INDICES_PER_PAGE = 1 << 12;
+
+template<class Vertex>
+core::MeshArena & arenaOf() {
+    static core::MeshArena & arena = *new core::MeshArena(sizeof(Vertex), VERTICES_PER_PAGE, INDICES_PER_PAGE);
+    return arena;
+}
+
+// Welded meshes keep the order of their source triangles, which is not the
+// one the post-transform cache wants.
+template<class Mesh>
+Mesh optimized(std::string_view name, Mesh mesh) {
+    using Vertex = typename Mesh::VertexType;
+    using Index = typename Mesh::IndexType;
+    auto report = core::optimizeMesh(std::span<Vertex>(mesh.vertices), std::span<Index>(mesh.indices));
+    core::mesh_optimization::record(name, report);
+    return mesh;
+}
+
+template<class Vertex, size_t vertex_count, class Index, size_t index_count>
+SharedMesh add(std::array<Vertex, vertex_count> const & vertices, std::array<Index, index_count> const & indices) {
+    auto & arena = arenaOf<Vertex>();
+    return { &arena, arena.add(std::span<Vertex const>(vertices), std::span<Index const>(indices)) };
+}
+
+// Packed once optimised, positions cannot be read as glm::vec3 any more.
+auto const & texturedCubeWithNormals() {
+    static auto const mesh = optimized("textured cube with normals", INDEXED_TEXTURED_CUBE_WITH_NORMALS);
+    return mesh;
+}
+
+} // namespace
+
+SharedMesh const & indexedCube() {
+    static auto const cube = optimized("cube", INDEXED_CUBE);
+    static SharedMesh const mesh = add(cube.vertices, cube.indices);
+    return mesh;
+}
+
+SharedMesh const & indexedTexturedCube() {
+    static auto const cube = optimized("textured cube", INDEXED_TEXTURED_CUBE);
+    static SharedMesh const mesh = add(cube.vertices, cube.indices);
+    return mesh;
+}
+
+SharedMesh const & indexedCubeWithNormals() {
+    static auto const cube = optimized("cube with normals", INDEXED_CUBE_WITH_NORMALS);
+    static SharedMesh const mesh = add(cube.vertices, cube.indices);
+    return mesh;
+}
+
+SharedMesh const & indexedTexturedCubeWithNormals() {
+    auto const & cube = texturedCubeWithNormals();
+    static SharedMesh const mesh = add(cube.vertices, cube.indices);
+    return mesh;
+}
+
+SharedMesh const & packedTexturedCubeWithNormals() {
+    auto const & cube = texturedCubeWithNormals();
+    static SharedMesh const mesh = add(pack(cube.vertices), cube.indices);
+    return mesh;
+}
+
+} // namespace prim
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <core/mesh_arena.h>
+
+namespace prim {
+
+// A mesh in the `MeshArena` of its vertex format, which every lesson shares,
+// so lessons switch meshes without switching buffers.
+struct SharedMesh {
+    core::MeshArena * arena;
+    core::MeshArena::Handle handle;
+
+    core::MeshRange const & range() const { return arena->range(handle); }
+    core::VertexBuffer const & vertices() const { return arena->vertices(range().page); }
+    core::IndexBuffer const & indices() const { return arena->indices(range().page); }
+};
+
+// The indexed cubes of primitives.h, uploaded on first use.
+SharedMesh const & indexedCube();
+SharedMesh const & indexedTexturedCube();
+SharedMesh const & indexedCubeWithNormals();
+SharedMesh const & indexedTexturedCubeWithNormals();
+SharedMesh const & packedTexturedCubeWithNormals();
+
+} // namespace prim
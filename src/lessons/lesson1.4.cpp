@@ -91,11 +91,15 @@ struct : public core::Renderer {
     const char * name() const noexcept override { return "1.4:0.2"; }
 
     void prepare() override {
-        core::Indexer indices;
+        core::IndexerFor<RECTANGLE.size()> indices;
         indices.addQuad();
 
+        auto rectangle = RECTANGLE;
+        auto report = indices.optimize(std::span(rectangle));
+        core::mesh_optimization::record("1.4 rectangle", report);
+
         program.emplace();
-        vbo.emplace(RECTANGLE.data(), RECTANGLE.size(), sizeof(RECTANGLE[0]), core::BufferUsage::StaticDraw);
+        vbo.emplace(rectangle.data(), report.vertex_count_after, sizeof(rectangle[0]), core::BufferUsage::StaticDraw);
         ibo.emplace(indices.data(), indices.size(), core::BufferUsage::StaticDraw);
         drawer.emplace(*program, *vbo, *ibo);
     }
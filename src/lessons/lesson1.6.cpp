@@ -1,4 +1,5 @@
 #include "helpers/preset.h"
+#include <core/texture_streamer.h>
 
 namespace {
 
@@ -48,7 +49,7 @@ struct : public core::Renderer {
         program.emplace();
         vbo.emplace(prim::TEXTURED_RECTANGLE.data(), prim::TEXTURED_RECTANGLE.size(), sizeof(prim::TEXTURED_RECTANGLE[0]), core::BufferUsage::StaticDraw);
         drawer.emplace(*program, *vbo);
-        texture.emplace(core::loadResource(core::ImgResources::WoodContainer));
+        texture.emplace(core::bakedResource(core::ImgResources::WoodContainer));
     }
 
     void render() override {
@@ -117,7 +118,7 @@ struct : public core::Renderer {
         program.emplace();
         vbo.emplace(prim::TEXTURED_COLORED_RECTANGLE.data(), prim::TEXTURED_COLORED_RECTANGLE.size(), sizeof(prim::TEXTURED_COLORED_RECTANGLE[0]), core::BufferUsage::StaticDraw);
         drawer.emplace(*program, *vbo);
-        texture.emplace(core::loadResource(core::ImgResources::WoodContainer));
+        texture.emplace(core::bakedResource(core::ImgResources::WoodContainer));
     }
 
     void render() override {
@@ -151,24 +152,27 @@ constexpr auto VERTEX_SHADER_SOURCE =
 
 constexpr auto FRAGMENT_SHADER_SOURCE = 
     R"~(
-    uniform sampler2D sample1;
-    uniform sampler2D sample2;
+    uniform sampler2D atlas;
+    uniform vec4 uRegion1;
+    uniform vec4 uRegion2;
     varying vec2 fTexCoord;
 
     void main() {
-        gl_FragColor = mix(texture2D(sample1, fTexCoord), texture2D(sample2, fTexCoord), 0.2);
+        gl_FragColor = mix(texture2D(atlas, uRegion1.xy + fTexCoord * uRegion1.zw), texture2D(atlas, uRegion2.xy + fTexCoord * uRegion2.zw), 0.2);
     }
     )~";
 
 struct Program : public core::Program {
     Program()
         : core::Program(VERTEX_SHADER_SOURCE, FRAGMENT_SHADER_SOURCE, attributes())
-        , texture1(uniformLocation("sample1"), 0)
-        , texture2(uniformLocation("sample2"), 1)
+        , atlas(uniformLocation("atlas"), 0)
+        , region1(uniformLocation("uRegion1"))
+        , region2(uniformLocation("uRegion2"))
     {}
 
-    core::UniformTexture texture1;
-    core::UniformTexture texture2;
+    core::UniformTexture atlas;
+    core::UniformVec4f region1;
+    core::UniformVec4f region2;
 
     std::vector<core::Attribute> attributes() {
         return {{"vPosition", 2, core::Attribute::Type::Float},
@@ -184,13 +188,13 @@ struct : public core::Renderer {
         program.emplace();
         vbo.emplace(prim::TEXTURED_RECTANGLE.data(), prim::TEXTURED_RECTANGLE.size(), sizeof(prim::TEXTURED_RECTANGLE[0]), core::BufferUsage::StaticDraw);
         drawer.emplace(*program, *vbo);
-        texture1.emplace(core::loadResource(core::ImgResources::WoodContainer));
-        texture2.emplace(core::loadResource(core::ImgResources::AwesomeFace));
+        atlas.emplace(core::bakedResource(core::AtlasResources::WoodAndFace));
     }
 
     void render() override {
-        drawer->program().texture1.set(*texture1);
-        drawer->program().texture2.set(*texture2);
+        drawer->program().atlas.set(*atlas);
+        drawer->program().region1.set(atlas->region(0).transform());
+        drawer->program().region2.set(atlas->region(1).transform());
         drawer->draw(core::PrimitiveType::TriangleStrip);
         core::Texture2D::unbind();
     }
@@ -198,13 +202,44 @@ struct : public core::Renderer {
     std::optional<Program> program;
     std::optional<core::VertexBuffer> vbo;
     std::optional<core::Drawer<Program>> drawer;
-    std::optional<core::Texture2D> texture1;
-    std::optional<core::Texture2D> texture2;
+    std::optional<core::TextureAtlas> atlas;
 
 } instance;
 
 } // namespace task03
 
+namespace task04 {
+
+// Task 0.1 with a texture that is decoded in the background and streams in
+// level by level, the smallest first.
+struct : public core::Renderer {
+    const char * name() const noexcept override { return "1.6:0.4"; }
+
+    void prepare() override {
+        program.emplace();
+        vbo.emplace(prim::TEXTURED_RECTANGLE.data(), prim::TEXTURED_RECTANGLE.size(), sizeof(prim::TEXTURED_RECTANGLE[0]), core::BufferUsage::StaticDraw);
+        drawer.emplace(*program, *vbo);
+        streamer.emplace();
+        texture = &streamer->request(core::ImgResources::WoodContainer);
+    }
+
+    void render() override {
+        streamer->update();
+        drawer->program().texture.set(*texture);
+        drawer->draw(core::PrimitiveType::TriangleStrip);
+        core::Texture2D::unbind();
+    }
+
+    std::optional<task01::Program> program;
+    std::optional<core::VertexBuffer> vbo;
+    std::optional<core::Drawer<task01::Program>> drawer;
+    std::optional<core::TextureStreamer> streamer;
+    core::StreamedTexture const * texture = nullptr;
+
+} instance;
+
+} // namespace task04
+
 namespace task2 {
 
 constexpr prim::TexturedRectangle RECTANGLE = {{
@@ -214,6 +249,34 @@ constexpr prim::TexturedRectangle RECTANGLE = {{
     {{-0.5f, -0.5f}, {0, 2}}, // Left Bottom
 }};
 
+// Texture coordinates past 1 have to repeat, which an atlas region cannot do.
+constexpr auto FRAGMENT_SHADER_SOURCE = 
+    R"~(
+    uniform sampler2D sample1;
+    uniform sampler2D sample2;
+    varying vec2 fTexCoord;
+
+    void main() {
+        gl_FragColor = mix(texture2D(sample1, fTexCoord), texture2D(sample2, fTexCoord), 0.2);
+    }
+    )~";
+
+struct Program : public core::Program {
+    Program()
+        : core::Program(task03::VERTEX_SHADER_SOURCE, FRAGMENT_SHADER_SOURCE, attributes())
+        , texture1(uniformLocation("sample1"), 0)
+        , texture2(uniformLocation("sample2"), 1)
+    {}
+
+    core::UniformTexture texture1;
+    core::UniformTexture texture2;
+
+    std::vector<core::Attribute> attributes() {
+        return {{"vPosition", 2, core::Attribute::Type::Float},
+                {"vTexCoord", 2, core::Attribute::Type::Float}};
+    }
+};
+
 struct : public core::Renderer {
     const char * name() const noexcept override { return "1.6:2"; }
 
@@ -222,8 +285,8 @@ struct : public core::Renderer {
         program.emplace();
         vbo.emplace(RECTANGLE.data(), RECTANGLE.size(), sizeof(RECTANGLE[0]), core::BufferUsage::StaticDraw);
         drawer.emplace(*program, *vbo);
-        texture1.emplace(core::loadResource(core::ImgResources::WoodContainer));
-        texture2.emplace(core::loadResource(core::ImgResources::AwesomeFace));
+        texture1.emplace(core::bakedResource(core::ImgResources::WoodContainer));
+        texture2.emplace(core::bakedResource(core::ImgResources::AwesomeFace));
     }
 
     void render() override {
@@ -233,9 +296,9 @@ struct : public core::Renderer {
         core::Texture2D::unbind();
     }
 
-    std::optional<task03::Program> program;
+    std::optional<Program> program;
     std::optional<core::VertexBuffer> vbo;
-    std::optional<core::Drawer<task03::Program>> drawer;
+    std::optional<core::Drawer<Program>> drawer;
     std::optional<core::Texture2D> texture1;
     std::optional<core::Texture2D> texture2;
 
@@ -247,26 +310,29 @@ namespace task4 {
 
 constexpr auto FRAGMENT_SHADER_SOURCE = 
     R"~(
-    uniform sampler2D sample1;
-    uniform sampler2D sample2;
+    uniform sampler2D atlas;
+    uniform vec4 uRegion1;
+    uniform vec4 uRegion2;
     uniform float uMixStrength;
     varying vec2 fTexCoord;
 
     void main() {
-        gl_FragColor = mix(texture2D(sample1, fTexCoord), texture2D(sample2, fTexCoord), uMixStrength);
+        gl_FragColor = mix(texture2D(atlas, uRegion1.xy + fTexCoord * uRegion1.zw), texture2D(atlas, uRegion2.xy + fTexCoord * uRegion2.zw), uMixStrength);
     }
     )~";
 
 struct Program : public core::Program {
     Program()
         : core::Program(task03::VERTEX_SHADER_SOURCE, FRAGMENT_SHADER_SOURCE, attributes())
-        , texture1(uniformLocation("sample1"), 0)
-        , texture2(uniformLocation("sample2"), 1)
+        , atlas(uniformLocation("atlas"), 0)
+        , region1(uniformLocation("uRegion1"))
+        , region2(uniformLocation("uRegion2"))
         , mixStrength(uniformLocation("uMixStrength"))
     {}
 
-    core::UniformTexture texture1;
-    core::UniformTexture texture2;
+    core::UniformTexture atlas;
+    core::UniformVec4f region1;
+    core::UniformVec4f region2;
     core::UniformFloat mixStrength;
 
     std::vector<core::Attribute> attributes() {
@@ -283,13 +349,13 @@ struct : public core::Renderer {
         program.emplace();
         vbo.emplace(prim::TEXTURED_RECTANGLE.data(), prim::TEXTURED_RECTANGLE.size(), sizeof(prim::TEXTURED_RECTANGLE[0]), core::BufferUsage::StaticDraw);
         drawer.emplace(*program, *vbo);
-        texture1.emplace(core::loadResource(core::ImgResources::WoodContainer));
-        texture2.emplace(core::loadResource(core::ImgResources::AwesomeFace));
+        atlas.emplace(core::bakedResource(core::AtlasResources::WoodAndFace));
     }
 
     void render() override {
-        drawer->program().texture1.set(*texture1);
-        drawer->program().texture2.set(*texture2);
+        drawer->program().atlas.set(*atlas);
+        drawer->program().region1.set(atlas->region(0).transform());
+        drawer->program().region2.set(atlas->region(1).transform());
         drawer->program().mixStrength.set(mixStrength);
         drawer->draw(core::PrimitiveType::TriangleStrip);
         core::Texture2D::unbind();
@@ -308,8 +374,7 @@ struct : public core::Renderer {
     std::optional<Program> program;
     std::optional<core::VertexBuffer> vbo;
     std::optional<core::Drawer<Program>> drawer;
-    std::optional<core::Texture2D> texture1;
-    std::optional<core::Texture2D> texture2;
+    std::optional<core::TextureAtlas> atlas;
     float mixStrength = 0.2f;
 
 } instance;
@@ -20,27 +20,30 @@ constexpr auto VERTEX_SHADER_SOURCE =
 
 constexpr auto FRAGMENT_SHADER_SOURCE = 
     R"~(
-    uniform sampler2D sample1;
-    uniform sampler2D sample2;
+    uniform sampler2D atlas;
+    uniform vec4 uRegion1;
+    uniform vec4 uRegion2;
     uniform float uMixStrength;
     varying vec2 fTexCoord;
 
     void main() {
-        gl_FragColor = mix(texture2D(sample1, fTexCoord), texture2D(sample2, fTexCoord), uMixStrength);
+        gl_FragColor = mix(texture2D(atlas, uRegion1.xy + fTexCoord * uRegion1.zw), texture2D(atlas, uRegion2.xy + fTexCoord * uRegion2.zw), uMixStrength);
     }
     )~";
 
 struct Program : public core::Program {
     Program()
         : core::Program(VERTEX_SHADER_SOURCE, FRAGMENT_SHADER_SOURCE, attributes())
-        , texture1(uniformLocation("sample1"), 0)
-        , texture2(uniformLocation("sample2"), 1)
+        , atlas(uniformLocation("atlas"), 0)
+        , region1(uniformLocation("uRegion1"))
+        , region2(uniformLocation("uRegion2"))
         , mixStrength(uniformLocation("uMixStrength"))
         , mvp(uniformLocation("uMVP"))
     {}
 
-    core::UniformTexture texture1;
-    core::UniformTexture texture2;
+    core::UniformTexture atlas;
+    core::UniformVec4f region1;
+    core::UniformVec4f region2;
     core::UniformFloat mixStrength;
     core::UniformMat4f mvp;
 
@@ -58,16 +61,16 @@ struct : public core::Renderer {
         program.emplace();
         vbo.emplace(prim::TEXTURED_RECTANGLE.data(), prim::TEXTURED_RECTANGLE.size(), sizeof(prim::TEXTURED_RECTANGLE[0]), core::BufferUsage::StaticDraw);
         drawer.emplace(*program, *vbo);
-        texture1.emplace(core::loadResource(core::ImgResources::WoodContainer));
-        texture2.emplace(core::loadResource(core::ImgResources::AwesomeFace));
+        atlas.emplace(core::bakedResource(core::AtlasResources::WoodAndFace));
 
         mvp = glm::rotate(glm::one<glm::mat4>(), glm::radians(90.0f), {0, 0, 1});
         mvp = glm::scale(mvp, {0.5f, 0.5f, 0.5f});
     }
 
     void render() override {
-        drawer->program().texture1.set(*texture1);
-        drawer->program().texture2.set(*texture2);
+        drawer->program().atlas.set(*atlas);
+        drawer->program().region1.set(atlas->region(0).transform());
+        drawer->program().region2.set(atlas->region(1).transform());
         drawer->program().mixStrength.set(mixStrength);
         drawer->program().mvp.set(mvp);
         drawer->draw(core::PrimitiveType::TriangleStrip);
@@ -87,8 +90,7 @@ struct : public core::Renderer {
     std::optional<Program> program;
     std::optional<core::VertexBuffer> vbo;
     std::optional<core::Drawer<Program>> drawer;
-    std::optional<core::Texture2D> texture1;
-    std::optional<core::Texture2D> texture2;
+    std::optional<core::TextureAtlas> atlas;
     float mixStrength = 0.2f;
     glm::mat4 mvp;
 
@@ -106,8 +108,7 @@ struct : public core::Renderer {
         program.emplace();
         vbo.emplace(prim::TEXTURED_RECTANGLE.data(), prim::TEXTURED_RECTANGLE.size(), sizeof(prim::TEXTURED_RECTANGLE[0]), core::BufferUsage::StaticDraw);
         drawer.emplace(*program, *vbo);
-        texture1.emplace(core::loadResource(core::ImgResources::WoodContainer));
-        texture2.emplace(core::loadResource(core::ImgResources::AwesomeFace));
+        atlas.emplace(core::bakedResource(core::AtlasResources::WoodAndFace));
         animation.emplace(2s, [](auto t) { return 2 * t * std::numbers::pi_v<float>; } );
     }
 
@@ -115,8 +116,9 @@ struct : public core::Renderer {
         auto mvp = glm::translate(glm::one<glm::mat4>(), {0.5, -0.5, 0});
         mvp = glm::rotate(mvp, animation->progress(), {0, 0, 1});
 
-        drawer->program().texture1.set(*texture1);
-        drawer->program().texture2.set(*texture2);
+        drawer->program().atlas.set(*atlas);
+        drawer->program().region1.set(atlas->region(0).transform());
+        drawer->program().region2.set(atlas->region(1).transform());
         drawer->program().mixStrength.set(mixStrength);
         drawer->program().mvp.set(mvp);
         drawer->draw(core::PrimitiveType::TriangleStrip);
@@ -136,8 +138,7 @@ struct : public core::Renderer {
     std::optional<task01::Program> program;
     std::optional<core::VertexBuffer> vbo;
     std::optional<core::Drawer<task01::Program>> drawer;
-    std::optional<core::Texture2D> texture1;
-    std::optional<core::Texture2D> texture2;
+    std::optional<core::TextureAtlas> atlas;
     std::optional<core::LoopedAnimation> animation;
     float mixStrength = 0.2f;
 
@@ -155,8 +156,7 @@ struct : public core::Renderer {
         program.emplace();
         vbo.emplace(prim::TEXTURED_RECTANGLE.data(), prim::TEXTURED_RECTANGLE.size(), sizeof(prim::TEXTURED_RECTANGLE[0]), core::BufferUsage::StaticDraw);
         drawer.emplace(*program, *vbo);
-        texture1.emplace(core::loadResource(core::ImgResources::WoodContainer));
-        texture2.emplace(core::loadResource(core::ImgResources::AwesomeFace));
+        atlas.emplace(core::bakedResource(core::AtlasResources::WoodAndFace));
         animation.emplace(2s, [](auto t) { return 2 * t * std::numbers::pi_v<float>; } );
     }
 
@@ -166,8 +166,9 @@ struct : public core::Renderer {
         auto mvp2 = glm::translate(glm::one<glm::mat4>(), {-0.5, 0.5, 0});
         mvp2 = glm::rotate(mvp2, animation->progress(), {0, 0, 1});
 
-        drawer->program().texture1.set(*texture1);
-        drawer->program().texture2.set(*texture2);
+        drawer->program().atlas.set(*atlas);
+        drawer->program().region1.set(atlas->region(0).transform());
+        drawer->program().region2.set(atlas->region(1).transform());
         drawer->program().mixStrength.set(mixStrength);
         drawer->program().mvp.set(mvp1);
         drawer->draw(core::PrimitiveType::TriangleStrip);
@@ -189,8 +190,7 @@ struct : public core::Renderer {
     std::optional<task01::Program> program;
     std::optional<core::VertexBuffer> vbo;
     std::optional<core::Drawer<task01::Program>> drawer;
-    std::optional<core::Texture2D> texture1;
-    std::optional<core::Texture2D> texture2;
+    std::optional<core::TextureAtlas> atlas;
     std::optional<core::LoopedAnimation> animation;
     float mixStrength = 0.2f;
 
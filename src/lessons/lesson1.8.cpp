@@ -1,4 +1,5 @@
 #include "helpers/preset.h"
+#include "helpers/shared_meshes.h"
 
 namespace {
 
@@ -22,29 +23,32 @@ constexpr auto VERTEX_SHADER_SOURCE =
 
 constexpr auto FRAGMENT_SHADER_SOURCE =
     R"~(
-    uniform sampler2D sample1;
-    uniform sampler2D sample2;
+    uniform sampler2D atlas;
+    uniform vec4 uRegion1;
+    uniform vec4 uRegion2;
     uniform float uMixStrength;
     varying vec2 fTexCoord;
 
     void main() {
-        gl_FragColor = mix(texture2D(sample1, fTexCoord), texture2D(sample2, fTexCoord), uMixStrength);
+        gl_FragColor = mix(texture2D(atlas, uRegion1.xy + fTexCoord * uRegion1.zw), texture2D(atlas, uRegion2.xy + fTexCoord * uRegion2.zw), uMixStrength);
     }
     )~";
 
 struct Program : public core::Program {
     Program()
         : core::Program(VERTEX_SHADER_SOURCE, FRAGMENT_SHADER_SOURCE, attributes())
-        , texture1(uniformLocation("sample1"), 0)
-        , texture2(uniformLocation("sample2"), 1)
+        , atlas(uniformLocation("atlas"), 0)
+        , region1(uniformLocation("uRegion1"))
+        , region2(uniformLocation("uRegion2"))
         , mixStrength(uniformLocation("uMixStrength"))
         , model(uniformLocation("uModel"))
         , view(uniformLocation("uView"))
         , projection(uniformLocation("uProjection"))
     {}
 
-    core::UniformTexture texture1;
-    core::UniformTexture texture2;
+    core::UniformTexture atlas;
+    core::UniformVec4f region1;
+    core::UniformVec4f region2;
     core::UniformFloat mixStrength;
     core::UniformMat4f model;
     core::UniformMat4f view;
@@ -64,8 +68,7 @@ struct : public core::Renderer {
         program.emplace();
         vbo.emplace(prim::TEXTURED_RECTANGLE.data(), prim::TEXTURED_RECTANGLE.size(), sizeof(prim::TEXTURED_RECTANGLE[0]), core::BufferUsage::StaticDraw);
         drawer.emplace(*program, *vbo);
-        texture1.emplace(core::loadResource(core::ImgResources::WoodContainer));
-        texture2.emplace(core::loadResource(core::ImgResources::AwesomeFace));
+        atlas.emplace(core::bakedResource(core::AtlasResources::WoodAndFace));
 
         model = glm::rotate(glm::one<glm::mat4>(), glm::radians(-55.0f), {1, 0, 0});
         view = glm::translate(glm::one<glm::mat4>(), {0, 0, -3});
@@ -73,8 +76,9 @@ struct : public core::Renderer {
     }
 
     void render() override {
-        drawer->program().texture1.set(*texture1);
-        drawer->program().texture2.set(*texture2);
+        drawer->program().atlas.set(*atlas);
+        drawer->program().region1.set(atlas->region(0).transform());
+        drawer->program().region2.set(atlas->region(1).transform());
         drawer->program().mixStrength.set(mixStrength);
 
         drawer->program().model.set(model);
@@ -98,8 +102,7 @@ struct : public core::Renderer {
     std::optional<Program> program;
     std::optional<core::VertexBuffer> vbo;
     std::optional<core::Drawer<Program>> drawer;
-    std::optional<core::Texture2D> texture1;
-    std::optional<core::Texture2D> texture2;
+    std::optional<core::TextureAtlas> atlas;
     float mixStrength = 0.2f;
     glm::mat4 model;
     glm::mat4 view;
@@ -130,16 +133,18 @@ constexpr auto VERTEX_SHADER_SOURCE =
 struct Program : public core::Program {
     Program()
         : core::Program(VERTEX_SHADER_SOURCE, task01::FRAGMENT_SHADER_SOURCE, attributes())
-        , texture1(uniformLocation("sample1"), 0)
-        , texture2(uniformLocation("sample2"), 1)
+        , atlas(uniformLocation("atlas"), 0)
+        , region1(uniformLocation("uRegion1"))
+        , region2(uniformLocation("uRegion2"))
         , mixStrength(uniformLocation("uMixStrength"))
         , model(uniformLocation("uModel"))
         , view(uniformLocation("uView"))
         , projection(uniformLocation("uProjection"))
     {}
 
-    core::UniformTexture texture1;
-    core::UniformTexture texture2;
+    core::UniformTexture atlas;
+    core::UniformVec4f region1;
+    core::UniformVec4f region2;
     core::UniformFloat mixStrength;
     core::UniformMat4f model;
     core::UniformMat4f view;
@@ -157,10 +162,9 @@ struct Task02 : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::TEXTURED_CUBE.data(), prim::TEXTURED_CUBE.size(), sizeof(prim::TEXTURED_CUBE[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
-        texture1.emplace(core::loadResource(core::ImgResources::WoodContainer));
-        texture2.emplace(core::loadResource(core::ImgResources::AwesomeFace));
+        cube = &prim::indexedTexturedCube();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
+        atlas.emplace(core::bakedResource(core::AtlasResources::WoodAndFace));
         view = glm::translate(glm::one<glm::mat4>(), {0, 0, -3});
         projection = glm::perspective(45.0f, WidthHeightRatio(), 0.1f, 100.0f);
         animation.emplace(3s, [](auto t) { return 2 * t * std::numbers::pi_v<float>; } );
@@ -169,14 +173,15 @@ struct Task02 : public core::Renderer {
     void render() override {
         auto model = glm::rotate(glm::one<glm::mat4>(), animation->progress(), {0.5, 1, 0});
 
-        drawer->program().texture1.set(*texture1);
-        drawer->program().texture2.set(*texture2);
+        drawer->program().atlas.set(*atlas);
+        drawer->program().region1.set(atlas->region(0).transform());
+        drawer->program().region2.set(atlas->region(1).transform());
         drawer->program().mixStrength.set(mixStrength);
         drawer->program().model.set(model);
         drawer->program().view.set(view);
         drawer->program().projection.set(projection);
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
 
         core::Texture2D::unbind();
     }
@@ -192,10 +197,9 @@ struct Task02 : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
-    std::optional<core::Texture2D> texture1;
-    std::optional<core::Texture2D> texture2;
+    std::optional<core::TextureAtlas> atlas;
     std::optional<core::LoopedAnimation> animation;
     glm::mat4 view;
     glm::mat4 projection;
@@ -225,15 +229,16 @@ struct Task04 : task03::Task03 {
     const char * name() const noexcept override { return "1.8:0.4"; }
 
     void render() override {
-        drawer->program().texture1.set(*texture1);
-        drawer->program().texture2.set(*texture2);
+        drawer->program().atlas.set(*atlas);
+        drawer->program().region1.set(atlas->region(0).transform());
+        drawer->program().region2.set(atlas->region(1).transform());
         drawer->program().mixStrength.set(mixStrength);
         drawer->program().view.set(view);
         drawer->program().projection.set(projection);
 
         for (auto const & model : prim::TEN_CUBES_MODEL_MATRICES) {
             drawer->program().model.set(model);
-            drawer->draw(core::PrimitiveType::Triangles);
+            drawer->draw(core::PrimitiveType::Triangles, cube->range());
         }
 
         core::Texture2D::unbind();
@@ -249,8 +254,9 @@ struct : task04::Task04 {
     const char * name() const noexcept override { return "1.8:3"; }
 
     void render() override {
-        drawer->program().texture1.set(*texture1);
-        drawer->program().texture2.set(*texture2);
+        drawer->program().atlas.set(*atlas);
+        drawer->program().region1.set(atlas->region(0).transform());
+        drawer->program().region2.set(atlas->region(1).transform());
         drawer->program().mixStrength.set(mixStrength);
         drawer->program().view.set(view);
         drawer->program().projection.set(projection);
@@ -262,7 +268,7 @@ struct : task04::Task04 {
             model = glm::rotate(model, angle, {1.0f, 0.3f, 0.5f});
 
             drawer->program().model.set(model);
-            drawer->draw(core::PrimitiveType::Triangles);
+            drawer->draw(core::PrimitiveType::Triangles, cube->range());
         }
 
         core::Texture2D::unbind();
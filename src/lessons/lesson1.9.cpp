@@ -1,4 +1,5 @@
 #include "helpers/preset.h"
+#include "helpers/shared_meshes.h"
 
 namespace {
 
@@ -21,28 +22,31 @@ constexpr auto VERTEX_SHADER_SOURCE =
 
 constexpr auto FRAGMENT_SHADER_SOURCE =
     R"~(
-    uniform sampler2D sample1;
-    uniform sampler2D sample2;
+    uniform sampler2D atlas;
+    uniform vec4 uRegion1;
+    uniform vec4 uRegion2;
     uniform float uMixStrength;
     varying vec2 fTexCoord;
 
     void main() {
-        gl_FragColor = mix(texture2D(sample1, fTexCoord), texture2D(sample2, fTexCoord), uMixStrength);
+        gl_FragColor = mix(texture2D(atlas, uRegion1.xy + fTexCoord * uRegion1.zw), texture2D(atlas, uRegion2.xy + fTexCoord * uRegion2.zw), uMixStrength);
     }
     )~";
 
 struct Program : public core::Program {
     Program()
         : core::Program(VERTEX_SHADER_SOURCE, FRAGMENT_SHADER_SOURCE, attributes())
-        , texture1(uniformLocation("sample1"), 0)
-        , texture2(uniformLocation("sample2"), 1)
+        , atlas(uniformLocation("atlas"), 0)
+        , region1(uniformLocation("uRegion1"))
+        , region2(uniformLocation("uRegion2"))
         , mixStrength(uniformLocation("uMixStrength"))
         , model(uniformLocation("uModel"))
         , viewProjection(uniformLocation("uViewProjection"))
     {}
 
-    core::UniformTexture texture1;
-    core::UniformTexture texture2;
+    core::UniformTexture atlas;
+    core::UniformVec4f region1;
+    core::UniformVec4f region2;
     core::UniformFloat mixStrength;
     core::UniformMat4f model;
     core::UniformMat4f viewProjection;
@@ -60,18 +64,18 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::TEXTURED_CUBE.data(), prim::TEXTURED_CUBE.size(), sizeof(prim::TEXTURED_CUBE[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
-        texture1.emplace(core::loadResource(core::ImgResources::WoodContainer));
-        texture2.emplace(core::loadResource(core::ImgResources::AwesomeFace));
+        cube = &prim::indexedTexturedCube();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
+        atlas.emplace(core::bakedResource(core::AtlasResources::WoodAndFace));
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{0, 0, 3}));
         animation.emplace(3s, [](auto t) { return 2 * t * std::numbers::pi_v<float>; } );
     }
 
     void render(float frame_delta_time) override {
         actor->precessMovement(frame_delta_time);
-        drawer->program().texture1.set(*texture1);
-        drawer->program().texture2.set(*texture2);
+        drawer->program().atlas.set(*atlas);
+        drawer->program().region1.set(atlas->region(0).transform());
+        drawer->program().region2.set(atlas->region(1).transform());
         drawer->program().mixStrength.set(mixStrength);
         drawer->program().viewProjection.set(actor->viewProj());
 
@@ -82,7 +86,7 @@ struct : public core::Renderer {
             model = glm::rotate(model, angle, {1.0f, 0.3f, 0.5f});
 
             drawer->program().model.set(model);
-            drawer->draw(core::PrimitiveType::Triangles);
+            drawer->draw(core::PrimitiveType::Triangles, cube->range());
         }
 
         core::Texture2D::unbind();
@@ -113,10 +117,9 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
-    std::optional<core::Texture2D> texture1;
-    std::optional<core::Texture2D> texture2;
+    std::optional<core::TextureAtlas> atlas;
     std::optional<core::LoopedAnimation> animation;
     std::optional<core::Actor> actor;
 
@@ -1,4 +1,5 @@
 #include "helpers/preset.h"
+#include "helpers/shared_meshes.h"
 #include "helpers/cube_lamp.h"
 
 namespace {
@@ -53,8 +54,8 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::CUBE.data(), prim::CUBE.size(), sizeof(prim::CUBE[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedCube();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
@@ -68,7 +69,7 @@ struct : public core::Renderer {
         drawer->program().object_color.set({1.0f, 0.5f, 0.31f});
         drawer->program().light_color.set({1, 1, 1});
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -89,7 +90,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::Actor> actor;
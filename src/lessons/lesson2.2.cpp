@@ -1,4 +1,5 @@
 #include "helpers/preset.h"
+#include "helpers/shared_meshes.h"
 #include "helpers/cube_lamp.h"
 #include <glm/gtx/quaternion.hpp>
 namespace {
@@ -56,8 +57,8 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::CUBE.data(), prim::CUBE.size(), sizeof(prim::CUBE[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedCube();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
@@ -71,7 +72,7 @@ struct : public core::Renderer {
         drawer->program().object_color.set({1.0f, 0.5f, 0.31f});
         drawer->program().light_color.set({1, 1, 1});
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -92,7 +93,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::Actor> actor;
@@ -172,8 +173,8 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::CUBE_WITH_NORMALS.data(), prim::CUBE_WITH_NORMALS.size(), sizeof(prim::CUBE_WITH_NORMALS[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
@@ -190,7 +191,7 @@ struct : public core::Renderer {
         drawer->program().object_color.set({1.0f, 0.5f, 0.31f});
         drawer->program().light_color.set({1, 1, 1});
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -211,7 +212,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::FPSActor> actor;
@@ -282,8 +283,8 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::CUBE_WITH_NORMALS.data(), prim::CUBE_WITH_NORMALS.size(), sizeof(prim::CUBE_WITH_NORMALS[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
@@ -301,7 +302,7 @@ struct : public core::Renderer {
         drawer->program().light_color.set({1, 1, 1});
         drawer->program().view_pos.set(actor->pos());
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -322,7 +323,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::FPSActor> actor;
@@ -342,8 +343,8 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::CUBE_WITH_NORMALS.data(), prim::CUBE_WITH_NORMALS.size(), sizeof(prim::CUBE_WITH_NORMALS[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace(BASE_LIGHT_POS);
         animation.emplace(10s, [](float t) { return 2 * t * std::numbers::pi_v<float>; });
@@ -364,7 +365,7 @@ struct : public core::Renderer {
         lamp->light.position = glm::rotate(glm::angleAxis(animation->progress(), glm::vec3{0, 1, 0}), BASE_LIGHT_POS);
         drawer->program().light_pos.set(lamp->light.position);
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -385,7 +386,7 @@ struct : public core::Renderer {
     }
 
     std::optional<task03::Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<task03::Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::FPSActor> actor;
@@ -480,8 +481,8 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::CUBE_WITH_NORMALS.data(), prim::CUBE_WITH_NORMALS.size(), sizeof(prim::CUBE_WITH_NORMALS[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
@@ -499,7 +500,7 @@ struct : public core::Renderer {
         drawer->program().light_color.set({1, 1, 1});
         drawer->program().view_pos.set(actor->pos());
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -520,7 +521,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::FPSActor> actor;
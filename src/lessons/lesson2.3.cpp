@@ -1,4 +1,5 @@
 #include "helpers/preset.h"
+#include "helpers/shared_meshes.h"
 #include "helpers/cube_lamp.h"
 
 namespace {
@@ -90,8 +91,8 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::CUBE_WITH_NORMALS.data(), prim::CUBE_WITH_NORMALS.size(), sizeof(prim::CUBE_WITH_NORMALS[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
@@ -115,7 +116,7 @@ struct : public core::Renderer {
         drawer->program().view_projection.set(viewProj);
         drawer->program().view_pos.set(actor->pos());
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -136,7 +137,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::FPSActor> actor;
@@ -218,8 +219,8 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::CUBE_WITH_NORMALS.data(), prim::CUBE_WITH_NORMALS.size(), sizeof(prim::CUBE_WITH_NORMALS[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
@@ -243,7 +244,7 @@ struct : public core::Renderer {
         drawer->program().view_projection.set(viewProj);
         drawer->program().view_pos.set(actor->pos());
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -264,7 +265,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::FPSActor> actor;
@@ -280,8 +281,8 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::CUBE_WITH_NORMALS.data(), prim::CUBE_WITH_NORMALS.size(), sizeof(prim::CUBE_WITH_NORMALS[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
@@ -312,7 +313,7 @@ struct : public core::Renderer {
         light.components.ambient = 0.2f * light.components.diffuse;
         drawer->program().light.set(light);
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -333,7 +334,7 @@ struct : public core::Renderer {
     }
 
     std::optional<task02::Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<task02::Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::FPSActor> actor;
@@ -352,8 +353,8 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        vbo.emplace(prim::CUBE_WITH_NORMALS.data(), prim::CUBE_WITH_NORMALS.size(), sizeof(prim::CUBE_WITH_NORMALS[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
@@ -384,7 +385,7 @@ struct : public core::Renderer {
         drawer->program().view_projection.set(viewProj);
         drawer->program().view_pos.set(actor->pos());
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -405,7 +406,7 @@ struct : public core::Renderer {
     }
 
     std::optional<task02::Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<task02::Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::FPSActor> actor;
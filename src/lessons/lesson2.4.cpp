@@ -1,4 +1,5 @@
 #include "helpers/preset.h"
+#include "helpers/shared_meshes.h"
 #include "helpers/cube_lamp.h"
 
 namespace {
@@ -101,22 +102,20 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        constexpr auto& cube = prim::TEXTURED_CUBE_WITH_NORMALS;
-        vbo.emplace(cube.data(), cube.size(), sizeof(cube[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedTexturedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
         material.emplace(
-            core::loadResource(core::ImgResources::Container2),
-            core::loadResource(core::ImgResources::Container2_specular),
+            core::bakedResource(core::ImgResources::Container2),
+            core::bakedResource(core::ImgResources::Container2_specular),
             64.0f
         );
 
         auto model_matrix = glm::one<glm::mat4>();
         drawer->program().model.set(model_matrix);
         drawer->program().normal_matrix.set(core::normalMatrix(model_matrix));
-        drawer->program().material.set(*material);
         drawer->program().light.set(lamp->simpleLight());
     }
 
@@ -125,8 +124,9 @@ struct : public core::Renderer {
         auto viewProj = actor->viewProj();
         drawer->program().view_projection.set(viewProj);
         drawer->program().view_pos.set(actor->pos());
+        drawer->program().material.set(*material);
 
-        drawer->draw(core::PrimitiveType::Triangles);
+        drawer->draw(core::PrimitiveType::Triangles, cube->range());
         lamp->draw(viewProj);
     }
 
@@ -147,7 +147,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::FPSActor> actor;
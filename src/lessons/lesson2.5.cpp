@@ -1,5 +1,6 @@
 #include "core/camera.h"
 #include "helpers/preset.h"
+#include "helpers/shared_meshes.h"
 #include "helpers/cube_lamp.h"
 #include <glm/trigonometric.hpp>
 
@@ -103,18 +104,16 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        constexpr auto& cube = prim::TEXTURED_CUBE_WITH_NORMALS;
-        vbo.emplace(cube.data(), cube.size(), sizeof(cube[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedTexturedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
 
         material.emplace(
-            core::loadResource(core::ImgResources::Container2),
-            core::loadResource(core::ImgResources::Container2_specular),
+            core::bakedResource(core::ImgResources::Container2),
+            core::bakedResource(core::ImgResources::Container2_specular),
             64.0f
         );
 
-        drawer->program().material.set(*material);
         drawer->program().light.set({
             .components = {
                 .ambient = glm::vec3(0.2f),
@@ -130,11 +129,12 @@ struct : public core::Renderer {
         auto viewProj = actor->viewProj();
         drawer->program().view_projection.set(viewProj);
         drawer->program().view_pos.set(actor->pos());
+        drawer->program().material.set(*material);
 
         for (auto const & model_matrix : prim::TEN_CUBES_MODEL_MATRICES) {
             drawer->program().model.set(model_matrix);
             drawer->program().normal_matrix.set(core::normalMatrix(model_matrix));
-            drawer->draw(core::PrimitiveType::Triangles);
+            drawer->draw(core::PrimitiveType::Triangles, cube->range());
         }
     }
 
@@ -155,7 +155,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<core::FPSActor> actor;
 
@@ -245,19 +245,17 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        constexpr auto& cube = prim::TEXTURED_CUBE_WITH_NORMALS;
-        vbo.emplace(cube.data(), cube.size(), sizeof(cube[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedTexturedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
         lamp.emplace();
 
         material.emplace(
-            core::loadResource(core::ImgResources::Container2),
-            core::loadResource(core::ImgResources::Container2_specular),
+            core::bakedResource(core::ImgResources::Container2),
+            core::bakedResource(core::ImgResources::Container2_specular),
             64.0f
         );
 
-        drawer->program().material.set(*material);
         drawer->program().light.set(lamp->light);
     }
 
@@ -266,11 +264,12 @@ struct : public core::Renderer {
         auto viewProj = actor->viewProj();
         drawer->program().view_projection.set(viewProj);
         drawer->program().view_pos.set(actor->pos());
+        drawer->program().material.set(*material);
 
         for (auto const & model_matrix : prim::TEN_CUBES_MODEL_MATRICES) {
             drawer->program().model.set(model_matrix);
             drawer->program().normal_matrix.set(core::normalMatrix(model_matrix));
-            drawer->draw(core::PrimitiveType::Triangles);
+            drawer->draw(core::PrimitiveType::Triangles, cube->range());
         }
         lamp->draw(viewProj);
     }
@@ -292,7 +291,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<lamp::CubeLamp> lamp;
     std::optional<core::FPSActor> actor;
@@ -393,18 +392,15 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        constexpr auto& cube = prim::TEXTURED_CUBE_WITH_NORMALS;
-        vbo.emplace(cube.data(), cube.size(), sizeof(cube[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedTexturedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
 
         material.emplace(
-            core::loadResource(core::ImgResources::Container2),
-            core::loadResource(core::ImgResources::Container2_specular),
+            core::bakedResource(core::ImgResources::Container2),
+            core::bakedResource(core::ImgResources::Container2_specular),
             64.0f
         );
-
-        drawer->program().material.set(*material);
     }
 
     void render(float frame_delta_time) override {
@@ -412,6 +408,7 @@ struct : public core::Renderer {
         auto viewProj = actor->viewProj();
         drawer->program().view_projection.set(viewProj);
         drawer->program().view_pos.set(actor->pos());
+        drawer->program().material.set(*material);
 
         drawer->program().light.set({
             .components = {
@@ -430,7 +427,7 @@ struct : public core::Renderer {
         for (auto const & model_matrix : prim::TEN_CUBES_MODEL_MATRICES) {
             drawer->program().model.set(model_matrix);
             drawer->program().normal_matrix.set(core::normalMatrix(model_matrix));
-            drawer->draw(core::PrimitiveType::Triangles);
+            drawer->draw(core::PrimitiveType::Triangles, cube->range());
         }
     }
 
@@ -451,7 +448,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<core::FPSActor> actor;
 
@@ -554,18 +551,15 @@ struct : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        constexpr auto& cube = prim::TEXTURED_CUBE_WITH_NORMALS;
-        vbo.emplace(cube.data(), cube.size(), sizeof(cube[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::indexedTexturedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
 
         material.emplace(
-            core::loadResource(core::ImgResources::Container2),
-            core::loadResource(core::ImgResources::Container2_specular),
+            core::bakedResource(core::ImgResources::Container2),
+            core::bakedResource(core::ImgResources::Container2_specular),
             64.0f
         );
-
-        drawer->program().material.set(*material);
     }
 
     void render(float frame_delta_time) override {
@@ -573,6 +567,7 @@ struct : public core::Renderer {
         auto viewProj = actor->viewProj();
         drawer->program().view_projection.set(viewProj);
         drawer->program().view_pos.set(actor->pos());
+        drawer->program().material.set(*material);
 
         drawer->program().light.set({
             .components = {
@@ -592,7 +587,7 @@ struct : public core::Renderer {
         for (auto const & model_matrix : prim::TEN_CUBES_MODEL_MATRICES) {
             drawer->program().model.set(model_matrix);
             drawer->program().normal_matrix.set(core::normalMatrix(model_matrix));
-            drawer->draw(core::PrimitiveType::Triangles);
+            drawer->draw(core::PrimitiveType::Triangles, cube->range());
         }
     }
 
@@ -613,7 +608,7 @@ struct : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<core::FPSActor> actor;
 
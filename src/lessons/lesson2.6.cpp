@@ -1,8 +1,12 @@
 #include "core/camera.h"
+#include "core/frame_arena.h"
 #include "core/light.h"
 #include "core/program.h"
+#include "core/stream_ring_buffer.h"
 #include "helpers/preset.h"
+#include "helpers/shared_meshes.h"
 #include "helpers/cube_lamp.h"
+#include <algorithm>
 #include <array>
 #include <glm/fwd.hpp>
 #include <glm/trigonometric.hpp>
@@ -190,9 +194,9 @@ struct Program : public core::Program {
     core::UniformMat3f normal_matrix;
 
     std::vector<core::Attribute> attributes() {
-        return {{"vPosition",  3, core::Attribute::Type::Float},
-                {"vTexCoords", 2, core::Attribute::Type::Float},
-                {"vNormal",    3, core::Attribute::Type::Float}};
+        return {{"vPosition",  3, core::Attribute::Type::HalfFloat},
+                {"vTexCoords", 2, core::Attribute::Type::UnsignedShort, true},
+                {"vNormal",    4, core::Attribute::Type::Int2_10_10_10_Rev, true}};
     }
 };
 
@@ -203,6 +207,12 @@ struct Config {
     glm::vec3 clearColor;
 };
 
+struct DrawKey {
+    // Squared, from the camera to the center of the cube.
+    float distance;
+    size_t cube;
+};
+
 struct RendererBase : public core::Renderer {
     RendererBase(Config&& config)
         : config(config)
@@ -213,18 +223,16 @@ struct RendererBase : public core::Renderer {
     void prepare() override {
         using namespace std::chrono_literals;
         program.emplace();
-        constexpr auto& cube = prim::TEXTURED_CUBE_WITH_NORMALS;
-        vbo.emplace(cube.data(), cube.size(), sizeof(cube[0]), core::BufferUsage::StaticDraw);
-        drawer.emplace(*program, *vbo);
+        cube = &prim::packedTexturedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
         actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
 
         material.emplace(
-            core::loadResource(core::ImgResources::Container2),
-            core::loadResource(core::ImgResources::Container2_specular),
+            core::bakedResource(core::ImgResources::Container2),
+            core::bakedResource(core::ImgResources::Container2_specular),
             64.0f
         );
 
-        drawer->program().material.set(*material);
 
         drawer->program().dirLight.set(config.dirLight);
 
@@ -241,15 +249,26 @@ struct RendererBase : public core::Renderer {
         auto viewProj = actor->viewProj();
         drawer->program().view_projection.set(viewProj);
         drawer->program().view_pos.set(actor->pos());
+        drawer->program().material.set(*material);
 
         config.spotLight.position = actor->pos(),
         config.spotLight.direction = actor->dir(),
         drawer->program().spotLight.set(config.spotLight);
 
-        for (auto const & model_matrix : prim::TEN_CUBES_MODEL_MATRICES) {
+        // Front to back, so the depth test drops hidden fragments before all the lights are shaded.
+        auto const & models = prim::TEN_CUBES_MODEL_MATRICES;
+        auto keys = core::frameArena().allocateArray<DrawKey>(models.size());
+        for (size_t i = 0; i < models.size(); ++i) {
+            auto offset = glm::vec3(models[i][3]) - actor->pos();
+            keys[i] = { glm::dot(offset, offset), i };
+        }
+        std::sort(keys.begin(), keys.end(), [](auto const & a, auto const & b) { return a.distance < b.distance; });
+
+        for (auto const & key : keys) {
+            auto const & model_matrix = models[key.cube];
             drawer->program().model.set(model_matrix);
             drawer->program().normal_matrix.set(core::normalMatrix(model_matrix));
-            drawer->draw(core::PrimitiveType::Triangles);
+            drawer->draw(core::PrimitiveType::Triangles, cube->range());
         }
 
         for (auto & lamp : lamps)
@@ -273,7 +292,7 @@ struct RendererBase : public core::Renderer {
     }
 
     std::optional<Program> program;
-    std::optional<core::VertexBuffer> vbo;
+    prim::SharedMesh const * cube = nullptr;
     std::optional<core::Drawer<Program>> drawer;
     std::optional<core::FPSActor> actor;
     std::vector<lamp::CubeLamp> lamps;
@@ -339,6 +358,274 @@ struct Task01 : RendererBase {
     const char * name() const noexcept override { return "2.6:0.1"; }
 } instanceTask1;
 
+#define CUBES 10
+
+// Values which change every frame. They are streamed as a uniform block where
+// buffers can stay mapped and set one by one elsewhere.
+constexpr auto STREAMED_FRAME_UNIFORMS =
+    R"~(
+    layout(std140) uniform Frame {
+        mat4 uViewProjection;
+        vec3 uViewPos;
+    };
+    )~";
+
+constexpr auto FRAME_UNIFORMS =
+    R"~(
+    uniform mat4 uViewProjection;
+    uniform vec3 uViewPos;
+    )~";
+
+// std140 layout of the Frame block.
+struct FrameUniforms {
+    glm::mat4 view_projection;
+    glm::vec3 view_pos;
+    float padding = 0;
+};
+
+static_assert(sizeof(FrameUniforms) == 80);
+
+constexpr unsigned int FRAME_BINDING = 0;
+// Room for the block at any offset alignment a driver may ask for.
+constexpr size_t FRAME_REGION_SIZE = 1 << 10;
+
+// Appended to the GLSL version and the frame uniforms.
+constexpr auto BATCHED_VERTEX_SHADER_SOURCE =
+    R"~(
+    in vec3 vPosition;
+    in vec2 vTexCoords;
+    in vec3 vNormal;
+    out vec3 fNormal;
+    out vec3 fPos;
+    out vec2 fTexCoords;
+    flat out int fMaterial;
+
+    const int cubeCount = )~" STRING(CUBES) R"~(;
+    uniform mat4 uModel[cubeCount];
+    uniform int uMaterialIndex[cubeCount];
+
+    void main() {
+        mat4 model = uModel[gl_InstanceID];
+        vec4 worldPos = model * vec4(vPosition, 1.0);
+        gl_Position = uViewProjection * worldPos;
+        fPos = vec3(worldPos);
+        fNormal = mat3(transpose(inverse(model))) * vNormal;
+        fTexCoords = vTexCoords;
+        fMaterial = uMaterialIndex[gl_InstanceID];
+    }
+    )~";
+
+// Appended to `core::MaterialBatch::shaderHeader` and the frame uniforms.
+constexpr auto BATCHED_FRAGMENT_SHADER_SOURCE =
+    R"~(
+    in vec3 fNormal;
+    in vec3 fPos;
+    in vec2 fTexCoords;
+    flat in int fMaterial;
+    out vec4 fragColor;
+
+    struct DirLight {
+        vec3 direction;
+        vec3 ambient;
+        vec3 diffuse;
+        vec3 specular;
+    };
+
+    struct PointLight {
+        vec3 position;
+        vec3 ambient;
+        vec3 diffuse;
+        vec3 specular;
+        float constant;
+        float linear;
+        float quadratic;
+    };
+
+    const int pointLightCount = )~" STRING(POINT_LIGHTS) R"~(;
+    uniform DirLight uDirLight;
+    uniform PointLight uPointLight[pointLightCount];
+
+    vec3 calcLight(vec3 lightDir, vec3 ambient, vec3 diffuse, vec3 specular, vec3 normal, vec3 viewDir) {
+        float diff = max(0.0, dot(lightDir, normal));
+        vec3 reflectDir = reflect(-lightDir, normal);
+        float spec = pow(max(0.0, dot(viewDir, reflectDir)), materialShininess(fMaterial));
+
+        vec3 diffuseFrag = materialDiffuse(fMaterial, fTexCoords);
+        vec3 specularFrag = materialSpecular(fMaterial, fTexCoords);
+        return ambient * diffuseFrag + diffuse * diffuseFrag * diff + specular * specularFrag * spec;
+    }
+
+    void main() {
+        vec3 normal = normalize(fNormal);
+        vec3 viewDir = normalize(uViewPos - fPos);
+
+        vec3 color = calcLight(normalize(-uDirLight.direction), uDirLight.ambient, uDirLight.diffuse, uDirLight.specular, normal, viewDir);
+        for (int i = 0; i < pointLightCount; ++i) {
+            PointLight light = uPointLight[i];
+            float distance = length(light.position - fPos);
+            float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+            color += attenuation * calcLight(normalize(light.position - fPos), light.ambient, light.diffuse, light.specular, normal, viewDir);
+        }
+
+        fragColor = vec4(color, 1.0);
+    }
+    )~";
+
+struct BatchedProgram : public core::Program {
+    BatchedProgram(core::MaterialBatch::Mode mode, bool streamed_frame)
+        : BatchedProgram(
+            mode,
+            streamed_frame,
+            std::string("#version 330 core\n") + frameUniforms(streamed_frame) + BATCHED_VERTEX_SHADER_SOURCE,
+            core::MaterialBatch::shaderHeader(mode) + frameUniforms(streamed_frame) + BATCHED_FRAGMENT_SHADER_SOURCE)
+    {}
+
+    core::UniformMaterialBatch materials;
+    core::UniformDirLight dirLight;
+    std::vector<core::UniformPointLight> pointLights;
+    std::vector<core::UniformMat4f> models;
+    std::vector<core::UniformInt> material_indices;
+    // Only when the frame uniforms are not streamed.
+    std::optional<core::UniformVec3f> view_pos;
+    std::optional<core::UniformMat4f> view_projection;
+
+    std::vector<core::Attribute> attributes() {
+        return {{"vPosition",  3, core::Attribute::Type::HalfFloat},
+                {"vTexCoords", 2, core::Attribute::Type::UnsignedShort, true},
+                {"vNormal",    4, core::Attribute::Type::Int2_10_10_10_Rev, true}};
+    }
+
+private:
+    static char const * frameUniforms(bool streamed) {
+        return streamed ? STREAMED_FRAME_UNIFORMS : FRAME_UNIFORMS;
+    }
+
+    BatchedProgram(core::MaterialBatch::Mode mode, bool streamed_frame, std::string const & vertex_shader_source, std::string const & fragment_shader_source)
+        : core::Program(vertex_shader_source.c_str(), fragment_shader_source.c_str(), attributes())
+        , materials(*this, mode, 0, 1)
+        , dirLight(*this)
+    {
+        if (streamed_frame) {
+            bindUniformBlock("Frame", FRAME_BINDING);
+        } else {
+            view_pos.emplace(uniformLocation("uViewPos"));
+            view_projection.emplace(uniformLocation("uViewProjection"));
+        }
+
+        pointLights.reserve(POINT_LIGHTS);
+        for (size_t i = 0; i < POINT_LIGHTS; ++i)
+            pointLights.emplace_back(*this, ("uPointLight[" + std::to_string(i) + "]").c_str());
+
+        models.reserve(CUBES);
+        material_indices.reserve(CUBES);
+        for (size_t i = 0; i < CUBES; ++i) {
+            models.emplace_back(uniformLocation("uModel[" + std::to_string(i) + "]"));
+            material_indices.emplace_back(uniformLocation("uMaterialIndex[" + std::to_string(i) + "]"));
+        }
+    }
+};
+
+// Two materials on ten cubes drawn with a single instanced call.
+struct : public core::Renderer {
+    const char * name() const noexcept override { return "2.6:batched"; }
+    bool captureCamera() const noexcept override { return true; }
+
+    void prepare() override {
+        auto mode = core::MaterialBatch::preferredMode();
+        bool streamed_frame = core::StreamRingBuffer::supported();
+        program.emplace(mode, streamed_frame);
+        if (streamed_frame)
+            frame_uniforms.emplace(FRAME_REGION_SIZE);
+        cube = &prim::packedTexturedCubeWithNormals();
+        drawer.emplace(*program, cube->vertices(), cube->indices());
+        actor.emplace(core::Camera(WidthHeightRatio(), glm::vec3{1, 1, 4}));
+
+        constexpr std::array resources = {
+            core::ImgResources::Container2,
+            core::ImgResources::Container2_specular,
+            core::ImgResources::WoodContainer,
+            core::ImgResources::AwesomeFace,
+        };
+        auto images = core::loadResources(resources);
+        std::array<core::MaterialImages, 2> materials = {{
+            { images[0].get(), images[1].get(), 64.0f },
+            { images[2].get(), images[3].get(), 16.0f },
+        }};
+        batch.emplace(materials, mode);
+
+        auto & prog = drawer->program();
+        prog.materials.set(*batch);
+        prog.dirLight.set({
+            .components = {
+                .ambient = glm::vec3(0.05f),
+                .diffuse = glm::vec3(0.4f),
+                .specular = glm::vec3(0.5f),
+            },
+            .direction = glm::vec3(-0.2f, -1.0f, -0.3f),
+        });
+
+        lamps.clear();
+        lamps.reserve(POINT_LIGHTS);
+        for (size_t i = 0; i < POINT_LIGHTS; ++i) {
+            lamps.emplace_back(makeDefaultPointLightAt(lightPos[i]));
+            prog.pointLights[i].set(lamps.back().light);
+        }
+
+        static_assert(prim::TEN_CUBES_MODEL_MATRICES.size() == CUBES);
+        for (size_t i = 0; i < CUBES; ++i) {
+            prog.models[i].set(prim::TEN_CUBES_MODEL_MATRICES[i]);
+            prog.material_indices[i].set(int(i % materials.size()));
+        }
+    }
+
+    void render(float frame_delta_time) override {
+        actor->precessMovement(frame_delta_time);
+        auto viewProj = actor->viewProj();
+        auto & prog = drawer->program();
+        if (frame_uniforms) {
+            frame_uniforms->beginFrame();
+            FrameUniforms frame = { .view_projection = viewProj, .view_pos = actor->pos() };
+            auto allocation = frame_uniforms->write(std::span<FrameUniforms const>(&frame, 1), frame_uniforms->uniformAlignment());
+            frame_uniforms->bindRange(core::StreamTarget::Uniform, FRAME_BINDING, allocation);
+        } else {
+            prog.view_projection->set(viewProj);
+            prog.view_pos->set(actor->pos());
+        }
+
+        drawer->drawInstanced(core::PrimitiveType::Triangles, cube->range(), CUBES);
+        if (frame_uniforms)
+            frame_uniforms->endFrame();
+
+        for (auto & lamp : lamps)
+            lamp.draw(viewProj);
+    }
+
+    void prepareFrameRendering() override {
+        glEnable(GL_DEPTH_TEST);
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    void keyAction(core::KeyAction action, core::Key key) override {
+        if (actor)
+            actor->keyAction(action, key);
+    }
+
+    void mouseMoveDelta(glm::vec2 delta) override {
+        if (actor)
+            actor->mouseMoveDelta(delta);
+    }
+
+    std::optional<BatchedProgram> program;
+    prim::SharedMesh const * cube = nullptr;
+    std::optional<core::Drawer<BatchedProgram>> drawer;
+    std::optional<core::FPSActor> actor;
+    std::vector<lamp::CubeLamp> lamps;
+    std::optional<core::MaterialBatch> batch;
+    std::optional<core::StreamRingBuffer> frame_uniforms;
+
+} instanceBatched;
+
 struct LightAttenuationCoeff {
     float constant;
     float linear;
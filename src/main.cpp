@@ -1,5 +1,10 @@
 #include "core/window.h"
+#include "core/frame_arena.h"
+#include "core/gpu_memory.h"
+#include "core/image_resource_loader.h"
+#include "core/mesh_optimizer.h"
 #include "core/renderer.h"
+#include "core/texture_residency.h"
 
 #include <vector>
 #include <iostream>
@@ -96,6 +101,11 @@ int main(int argc, char const * argv[]) {
         do {
             std::cout << "Selected solution: " << renderer->name() << std::endl;
             exit_reason = window.render(*renderer);
+            core::gpu_memory::report(std::cout);
+            core::frame_arena::report(std::cout);
+            core::image_cache::report(std::cout);
+            core::texture_residency::report(std::cout);
+            core::mesh_optimization::report(std::cout);
             if (exit_reason == core::Window::ExitReason::RequestedPrev) {
                 if (auto* prev_renderer = findPrevRenderer(renderer))
                     renderer = prev_renderer;